@@ -7,10 +7,27 @@
 #include <stb_image.h>
 
 #include <Shader.h>
+#include <ShaderProfiler.h>
+#include <EmbeddedShaders.h>
+#include <BatchRenderer2D.h>
+#include <CommandBuffer.h>
+#include <GpuProfiler.h>
+#include <RenderQueue.h>
+#include <GlDebug.h>
+#include <GlHandle.h>
+#include <GlState.h>
+#include <InstancedQuads.h>
+#include <ProgramPipeline.h>
+#include <Transform2D.h>
+#include <VertexArrayCache.h>
 #include <glm/glm.hpp>
+#include <glm/ext/matrix_transform.hpp>
 
 #include <iostream>
+#include <algorithm>
 #include <array>
+#include <memory>
+#include <random>
 #include <vector>
 
 extern "C" {
@@ -18,12 +35,25 @@ extern "C" {
     _declspec(dllexport) int AmdPowerXpressRequestHighPerformance = 1;
 }
 
+// what the render loop draws, switched with the number keys
+enum class Demo {
+    Rectangle, // 1: the textured rectangle, through CommandBuffer and RenderQueue
+    Batched,   // 2: a grid of small quads that BatchRenderer2D merges into one draw
+    Instanced, // 3: kInstancedQuadCount quads in a single instanced draw
+};
+
 void framebuffer_size_callback(GLFWwindow* window, int width, int height);
-void processInput(GLFWwindow* window);
+void processInput(GLFWwindow* window, Demo& demo);
 
 // settings
 constexpr unsigned int kScreenWidth = 800;
 constexpr unsigned int kScreenHeight = 600;
+constexpr int kBatchGridSize = 100;
+constexpr size_t kInstancedQuadCount = 100'000;
+
+// sampler uniforms of texture.frag, resolved once per program instead of by name on every call
+using Texture1Uniform = Uniform<"texture1", int>;
+using Texture2Uniform = Uniform<"texture2", int>;
 
 struct Vertex {
     glm::vec3 pos {};
@@ -31,168 +61,121 @@ struct Vertex {
     glm::vec2 tex {};
 };
 
-class Triangle {
-public:
-    Triangle(const Vertex& vertex1, const Vertex& vertex2, const Vertex& vertex3) : mVerticies { vertex1, vertex2, vertex3 } {
-        glGenVertexArrays(1, &mVAO);
-        glGenBuffers(1, &mVBO);
-
-        glBindVertexArray(mVAO);
-
-        glBindBuffer(GL_ARRAY_BUFFER, mVBO);
-        glBufferData(GL_ARRAY_BUFFER, mVerticies.size() * sizeof(Vertex), mVerticies.data(), GL_STATIC_DRAW);
+// matched by name against the attributes of whichever shader draws the mesh
+const VertexLayout kVertexLayout { VertexLayout::of<Vertex>({
+    VertexLayout::attribute("aPos", &Vertex::pos),
+    VertexLayout::attribute("aColor", &Vertex::color),
+    VertexLayout::attribute("aTexCoord", &Vertex::tex) }) };
+
+// create a buffer object and upload data into it. the upload goes through the copy target, since binding
+// GL_ELEMENT_ARRAY_BUFFER would replace the index buffer of whichever VAO is bound; VertexArrayCache attaches it.
+template <typename T, size_t N>
+GlBuffer createBuffer(const std::array<T, N>& data) {
+    auto buffer { GlBuffer::create() };
+    GlState::shared().bindBuffer(GL_COPY_WRITE_BUFFER, buffer.get());
+    GLCHECK(glBufferData(GL_COPY_WRITE_BUFFER, data.size() * sizeof(T), data.data(), GL_STATIC_DRAW));
+    return buffer;
+}
 
-        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (const void*)0);
-        glEnableVertexAttribArray(0);
-        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (const void*)(3 * sizeof(float)));
-        glEnableVertexAttribArray(1);
-        glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (const void*)(6 * sizeof(float)));
-        glEnableVertexAttribArray(2);
-    }
+// load an image file into a new mipmapped, repeating texture
+GlTexture loadTexture(const char* path, const GLenum format) {
+    auto texture { GlTexture::create() };
+    GlState::shared().bindTexture(0, GL_TEXTURE_2D, texture.get());
 
-    void draw(const unsigned shaderProgram, const unsigned texture) {
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
 
-        glUseProgram(shaderProgram);
-        glUniform1i(glGetUniformLocation(shaderProgram, "ourTexture"), 0);
-        glBindTexture(GL_TEXTURE_2D, texture);
-        glBindVertexArray(mVAO);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
 
-        glDrawArrays(GL_TRIANGLES, 0, 3);
+    int width {}, height {}, nrChannels {};
+    unsigned char* data { stbi_load(path, &width, &height, &nrChannels, 0) };
+    if (data == nullptr) {
+        std::cerr << "Failed to load texture\n";
     }
+    GLCHECK(glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data));
+    stbi_image_free(data);
 
-    void rotate(const float angleRad) {
-
-        float centerX {};
-        float centerY {};
-        for (auto& vertex : mVerticies) {
-            centerX += vertex.pos.x;
-            centerY += vertex.pos.y;
-        }
-        centerX /= 3;
-        centerY /= 3;
-
-        const glm::mat3x3 translationMatrix1 { {1,        0,        0},
-                                               {0,        1,        0},
-                                               {-centerX, -centerY, 1} };
-        const glm::mat3x3 translationMatrix2 { {1,        0,        0},
-                                               {0,        1,        0},
-                                               {centerX,  centerY,  1} };
+    glGenerateMipmap(GL_TEXTURE_2D);
+    return texture;
+}
 
-        const glm::mat3x3 rotationMatrix { {glm::cos(angleRad)     , glm::sin(angleRad), 0},
-                                           {-glm::sin(angleRad)    , glm::cos(angleRad), 0},
-                                           {0                      , 0                 , 1} };
+class Triangle {
+public:
+    Triangle(const Vertex& vertex1, const Vertex& vertex2, const Vertex& vertex3)
+        : Triangle(std::array { vertex1, vertex2, vertex3 }) {}
 
-        const glm::mat3x3 matrixT { translationMatrix2 * rotationMatrix * translationMatrix1 };
+    // record the triangle; it is drawn once the list is submitted and flushed, so it has to live until then.
+    // no GL calls here, so this may run on any thread. ourTexture keeps its default unit 0.
+    void draw(CommandList& commands, Shader& shader, const unsigned texture) {
 
-        for (auto& vertex : mVerticies) {
-            vertex.pos = matrixT * vertex.pos;
-        }
+        RenderQueue::Draw draw { &shader, &mVertexArrays, { texture }, mTransform.model() };
+        draw.count = 3;
+        commands.draw(draw);
     }
 
-    void translate(const float moveX, const float moveY) {
-        for (auto& vertex : mVerticies) {
-            vertex.pos.x += moveX;
-            vertex.pos.y += moveY;
-        }
+    void rotate(const float angleRad) {
+        mTransform.rotate(angleRad);
     }
 
-    ~Triangle() {
-        glDeleteVertexArrays(1, &mVAO);
-        glDeleteBuffers(1, &mVBO);
+    void translate(const float moveX, const float moveY) {
+        mTransform.translate(moveX, moveY);
     }
 
 private:
-    std::array<Vertex, 3> mVerticies {};
-    unsigned int mVAO {};
-    unsigned int mVBO {};
+    GlBuffer mVBO;
+    VertexArrayCache mVertexArrays;
+    Transform2D mTransform;
+
+    explicit Triangle(const std::array<Vertex, 3>& verticies)
+        : mVBO { createBuffer(verticies) }, mVertexArrays { kVertexLayout, mVBO.get() }, mTransform { verticies } {}
 };
 
 class Rectangle {
 public:
-    Rectangle(const Vertex& vertex1, const Vertex& vertex2, const Vertex& vertex3, const Vertex& vertex4) : mVerticies { vertex1, vertex2, vertex3, vertex4 } {
-        glGenVertexArrays(1, &mVAO);
-        glGenBuffers(1, &mVBO); 
-        glGenBuffers(1, &mEBO);
-
-        glBindVertexArray(mVAO);
-
-        glBindBuffer(GL_ARRAY_BUFFER, mVBO);
-        glBufferData(GL_ARRAY_BUFFER, mVerticies.size() * sizeof(Vertex), mVerticies.data(), GL_STATIC_DRAW);
-
-        constexpr unsigned int indices[] { 0, 1, 3,
-                                           1, 2, 3 };
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mEBO);
-        glBufferData(GL_ELEMENT_ARRAY_BUFFER, std::size(indices) * sizeof(unsigned int), indices, GL_STATIC_DRAW);
-
-        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (const void*)0);
-        glEnableVertexAttribArray(0);
-        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (const void*)(3 * sizeof(float)));
-        glEnableVertexAttribArray(1);
-        glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (const void*)(6 * sizeof(float)));
-        glEnableVertexAttribArray(2);
+    Rectangle(const Vertex& vertex1, const Vertex& vertex2, const Vertex& vertex3, const Vertex& vertex4)
+        : Rectangle(std::array { vertex1, vertex2, vertex3, vertex4 }) {}
+
+    // record the rectangle; it is drawn once the list is submitted and flushed, so it has to live until then.
+    // no GL calls here, so this may run on any thread.
+    void draw(CommandList& commands, Shader& shader, const std::vector<unsigned int>& textures) {
+
+        RenderQueue::Draw draw { &shader, &mVertexArrays };
+        std::copy_n(textures.begin(), std::min(textures.size(), RenderQueue::kMaxTextures), draw.textures.begin());
+        draw.model = mTransform.model();
+        draw.count = static_cast<int>(kIndices.size());
+        draw.indexed = true;
+        commands.draw(draw);
     }
 
-    void draw(const unsigned shaderProgram, const std::vector<unsigned int>& textures) {
-
-        for (int i = 0; const auto & texture : textures) {
-            glActiveTexture(GL_TEXTURE0 + i);
-            glBindTexture(GL_TEXTURE_2D, texture);
-            i++;
-        }
-        glUseProgram(shaderProgram);
-
-        glBindVertexArray(mVAO);
-
-        glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
+    // draw right away with the bound program pipeline (see ProgramPipelineCache). shader only picks the VAO:
+    // texture.vert fixes its attribute locations, so a separable build of it reads the same ones.
+    void draw(SeparableProgram& vertexProgram, Shader& shader) {
+        mVertexArrays.bind(shader);
+        vertexProgram.setMat4("model", mTransform.model());
+        GLCHECK(glDrawElements(GL_TRIANGLES, static_cast<GLsizei>(kIndices.size()), GL_UNSIGNED_INT, nullptr));
     }
 
     void rotate(const float angleRad) {
-
-        float centerX {};
-        float centerY {};
-        for (auto& vertex : mVerticies) {
-            centerX += vertex.pos.x;
-            centerY += vertex.pos.y;
-        }
-        centerX /= 3;
-        centerY /= 3;
-
-        const glm::mat3x3 translationMatrix1 { {1,        0,        0},
-                                               {0,        1,        0},
-                                               {-centerX, -centerY, 1} };
-        const glm::mat3x3 translationMatrix2 { {1,        0,        0},
-                                               {0,        1,        0},
-                                               {centerX,  centerY,  1} };
-
-        const glm::mat3x3 rotationMatrix { {glm::cos(angleRad)     , glm::sin(angleRad), 0},
-                                           {-glm::sin(angleRad)    , glm::cos(angleRad), 0},
-                                           {0                      , 0                 , 1} };
-
-        const glm::mat3x3 matrixT { translationMatrix2 * rotationMatrix * translationMatrix1 };
-
-        for (auto& vertex : mVerticies) {
-            vertex.pos = matrixT * vertex.pos;
-        }
+        mTransform.rotate(angleRad);
     }
 
     void translate(const float moveX, const float moveY) {
-        for (auto& vertex : mVerticies) {
-            vertex.pos.x += moveX;
-            vertex.pos.y += moveY;
-        }
-    }
-
-    ~Rectangle() {
-        glDeleteVertexArrays(1, &mVAO);
-        glDeleteBuffers(1, &mVBO);
-        glDeleteBuffers(1, &mEBO);
+        mTransform.translate(moveX, moveY);
     }
 
 private:
-    std::array<Vertex, 4> mVerticies {};
-    unsigned int mVAO {};
-    unsigned int mVBO {};
-    unsigned int mEBO {};
+    static constexpr std::array<unsigned int, 6> kIndices { 0, 1, 3,
+                                                            1, 2, 3 };
+
+    GlBuffer mVBO;
+    GlBuffer mEBO;
+    VertexArrayCache mVertexArrays;
+    Transform2D mTransform;
+
+    explicit Rectangle(const std::array<Vertex, 4>& verticies)
+        : mVBO { createBuffer(verticies) }, mEBO { createBuffer(kIndices) },
+          mVertexArrays { kVertexLayout, mVBO.get(), mEBO.get() }, mTransform { verticies } {}
 };
 
 int main() {
@@ -206,6 +189,10 @@ int main() {
 #ifdef __APPLE__
     glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
 #endif
+#ifndef NDEBUG
+    // debug contexts are slower, but make the driver report errors through GlDebug
+    glfwWindowHint(GLFW_OPENGL_DEBUG_CONTEXT, GLFW_TRUE);
+#endif
 
     // glfw window creation
     // --------------------
@@ -229,6 +216,7 @@ int main() {
         std::cout << "Failed to initialize GLAD" << std::endl;
         return -1;
     }
+    GlDebug::enable();
 
     const char* vendor { reinterpret_cast<const char*>(glGetString(GL_VENDOR)) };
     const char* renderer { reinterpret_cast<const char*>(glGetString(GL_RENDERER)) };
@@ -236,9 +224,17 @@ int main() {
     std::cout << "Current OpenGL Vendor: " << vendor << '\n';
     std::cout << "Current OpenGL Renderer: " << renderer << '\n';
 
-    // build and compile our shader program
-    // ------------------------------------
-    Shader shader("Misc/Shaders/texture.vert", "Misc/Shaders/texture.frag"); // you can name your shader files however you like
+    // build and compile our shader program, reusing the linked binary from the previous run if possible
+    // --------------------------------------------------------------------------------------------------
+    Shader::setBinaryCacheDirectory("ShaderCache");
+    // the build is only submitted here; it finishes in the background while the textures below load, and shader.use() picks up the result.
+    // release builds use the copies compiled into the executable, debug builds read the files so edits are picked up while the program runs
+#ifdef NDEBUG
+    Shader shader(ShaderSource { EmbeddedShaders::find("texture.vert"), EmbeddedShaders::find("texture.frag") }, Shader::CompileMode::Deferred);
+#else
+    Shader shader("Misc/Shaders/texture.vert", "Misc/Shaders/texture.frag", Shader::CompileMode::Deferred); // you can name your shader files however you like
+    shader.enableHotReload();
+#endif
 
     // set up vertex data (and buffer(s)) and configure vertex attributes
     // ------------------------------------------------------------------
@@ -254,65 +250,115 @@ int main() {
     // glBindVertexArray(0);
 
     stbi_set_flip_vertically_on_load(true);
-    unsigned int texture1 {};
-    glGenTextures(1, &texture1);
-    glBindTexture(GL_TEXTURE_2D, texture1);
+    const auto texture1 { loadTexture("Misc/Textures/container.jpg", GL_RGB) };
+    const auto texture2 { loadTexture("Misc/Textures/awesomeface.png", GL_RGBA) };
 
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    
-    int width {}, height {}, nrChannels {};
-    unsigned char * data { stbi_load("Misc/Textures/container.jpg", &width, &height, &nrChannels, 0) };
-    if (data == nullptr) {
-        std::cerr << "Failed to load texture\n";
+    shader.use();
+    shader.set<Texture1Uniform>(0);
+    shader.set<Texture2Uniform>(1);
+
+    // texture.vert paired with basic.frag through a program pipeline, without linking that pair (hold F for vertex colours)
+    ProgramPipelineCache pipelines;
+    std::shared_ptr<SeparableProgram> separableVertex;
+    std::shared_ptr<SeparableProgram> colorFragment;
+    if (ProgramPipelineCache::supported()) {
+        separableVertex = std::make_shared<SeparableProgram>(SeparableProgram::Stage::Vertex, EmbeddedShaders::find("texture.vert"));
+        colorFragment = std::make_shared<SeparableProgram>(SeparableProgram::Stage::Fragment, EmbeddedShaders::find("basic.frag"));
+        if (!separableVertex->linked() || !colorFragment->linked()) {
+            separableVertex.reset();
+        }
     }
-    //glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, data);
-    stbi_image_free(data);
-
-    glGenerateMipmap(GL_TEXTURE_2D);
 
-    unsigned int texture2 {};
-    glGenTextures(1, &texture2);
-    glBindTexture(GL_TEXTURE_2D, texture2);
-
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-    data = stbi_load("Misc/Textures/awesomeface.png", &width, &height, &nrChannels, 0);
-    if (data == nullptr) {
-        std::cerr << "Failed to load texture\n";
+    // the batched and instanced demos draw the same two textures on many small quads
+    Demo demo { Demo::Rectangle };
+    BatchRenderer2D batch;
+    const std::array<BatchRenderer2D::Vertex, 4> batchQuad { {
+        { vertex1.pos, vertex1.color, vertex1.tex },
+        { vertex2.pos, vertex2.color, vertex2.tex },
+        { vertex3.pos, vertex3.color, vertex3.tex },
+        { vertex4.pos, vertex4.color, vertex4.tex } } };
+    InstancedQuads quads;
+    Shader instancedShader(ShaderSource { EmbeddedShaders::find("instanced.vert"), EmbeddedShaders::find("instanced.frag") },
+                           Shader::CompileMode::Deferred);
+    // where each instanced quad starts; only the rotation changes per frame
+    std::vector<InstancedQuads::Instance> scatter(kInstancedQuadCount);
+    std::mt19937 random { 1 };
+    std::uniform_real_distribution<float> unit { -1.0f, 1.0f };
+    for (size_t i = 0; i < scatter.size(); i++) {
+        scatter[i] = { glm::vec2(unit(random), unit(random)), glm::vec2(0.01f), unit(random) * 3.14159265f, static_cast<float>(i % 2),
+                       glm::vec4(1.0f) };
     }
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
-    stbi_image_free(data);
 
-    glGenerateMipmap(GL_TEXTURE_2D);
-
-    shader.use();
-    glUniform1i(glGetUniformLocation(shader.ID, "texture1"), 0);
-    glUniform1i(glGetUniformLocation(shader.ID, "texture2"), 1);
+    // draws are recorded in parallel during the frame, then queued and issued sorted by state
+    CommandBuffer commandBuffer;
+    RenderQueue renderQueue;
+    // per frame CPU and GPU times, read back a few frames late so nothing waits on the GPU
+    GpuProfiler gpuProfiler;
 
     // render loop
     // -----------
     while (!glfwWindowShouldClose(window)) {
+#ifndef NDEBUG
+        // hold P to stop reading timings back; once the ring is full frames are recorded with CPU times only
+        gpuProfiler.stallReadback(glfwGetKey(window, GLFW_KEY_P) == GLFW_PRESS);
+#endif
+        gpuProfiler.beginFrame();
+
         // input
         // -----
-        processInput(window);
+        processInput(window, demo);
 
         // render
         // ------
         glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
         glClear(GL_COLOR_BUFFER_BIT);
 
+        // a reloaded program starts with default uniform values, so the sampler units have to be set again
+        if (shader.reloadIfChanged()) {
+            shader.use();
+            shader.set<Texture1Uniform>(0);
+            shader.set<Texture2Uniform>(1);
+        }
+
         // render the triangle
-    
-        rectangle.draw(shader.ID, {texture1, texture2});
+        if (demo == Demo::Batched) {
+            const auto scope { gpuProfiler.scope("batched quads") };
+            const auto time { static_cast<float>(glfwGetTime()) };
+            for (int y = 0; y < kBatchGridSize; y++) {
+                for (int x = 0; x < kBatchGridSize; x++) {
+                    const glm::vec3 position { (x + 0.5f) * 2.0f / kBatchGridSize - 1.0f, (y + 0.5f) * 2.0f / kBatchGridSize - 1.0f, 0.0f };
+                    glm::mat4 model { glm::translate(glm::mat4(1.0f), position) };
+                    model = glm::rotate(model, time + 0.1f * static_cast<float>(x + y), glm::vec3(0.0f, 0.0f, 1.0f));
+                    model = glm::scale(model, glm::vec3(1.5f / kBatchGridSize));
+                    batch.drawQuad(shader, { texture1.get(), texture2.get() }, batchQuad, model);
+                }
+            }
+            batch.endFrame();
+        } else if (demo == Demo::Instanced) {
+            const auto scope { gpuProfiler.scope("instanced quads") };
+            const auto time { static_cast<float>(glfwGetTime()) };
+            // write each instance once, in order; the memory is mapped GL memory
+            auto instances { quads.instances(scatter.size()) };
+            for (size_t i = 0; i < instances.size(); i++) {
+                instances[i] = scatter[i];
+                instances[i].rotation += time;
+            }
+            quads.draw(instancedShader, { texture1.get(), texture2.get() });
+            quads.endFrame();
+        } else if (separableVertex && glfwGetKey(window, GLFW_KEY_F) == GLFW_PRESS) {
+            const auto scope { gpuProfiler.scope("rectangle (pipeline)") };
+            pipelines.bind(separableVertex, colorFragment);
+            rectangle.draw(*separableVertex, shader);
+        } else {
+            const auto scope { gpuProfiler.scope("rectangle") };
+            // record on the worker threads, then issue everything from this one, which owns the context
+            commandBuffer.record(1, [&](CommandList& commands, size_t, size_t) {
+                rectangle.draw(commands, shader, {texture1.get(), texture2.get()});
+            });
+            commandBuffer.submit(renderQueue);
+            renderQueue.flush();
+        }
+        gpuProfiler.endFrame();
 
         // glfw: swap buffers and poll IO events (keys pressed/released, mouse moved etc.)
         // -------------------------------------------------------------------------------
@@ -320,6 +366,14 @@ int main() {
         glfwPollEvents();
     }
 
+    // where startup went: read, compile, link and status query times of every program built this run
+    // ------------------------------------------------------------------------
+    ShaderProfiler::shared().writeReport("ShaderTimings.json");
+    gpuProfiler.writeReport("FrameTimings.json");
+    const auto& stateCounters { GlState::shared().counters() };
+    std::cout << "GL state calls issued: " << stateCounters.issued << ", skipped as redundant: " << stateCounters.skipped << '\n';
+    std::cout << "Batched shapes: " << batch.stats().shapes << " in " << batch.stats().draws << " draws\n";
+
     // optional: de-allocate all resources once they've outlived their purpose:
     // ------------------------------------------------------------------------
     // glfw: terminate, clearing all previously allocated GLFW resources.
@@ -330,9 +384,15 @@ int main() {
 
 // process all input: query GLFW whether relevant keys are pressed/released this frame and react accordingly
 // ---------------------------------------------------------------------------------------------------------
-void processInput(GLFWwindow* window) {
+void processInput(GLFWwindow* window, Demo& demo) {
     if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
         glfwSetWindowShouldClose(window, true);
+    if (glfwGetKey(window, GLFW_KEY_1) == GLFW_PRESS)
+        demo = Demo::Rectangle;
+    if (glfwGetKey(window, GLFW_KEY_2) == GLFW_PRESS)
+        demo = Demo::Batched;
+    if (glfwGetKey(window, GLFW_KEY_3) == GLFW_PRESS)
+        demo = Demo::Instanced;
 }
 
 // glfw: whenever the window size changed (by OS or user resize) this callback function executes
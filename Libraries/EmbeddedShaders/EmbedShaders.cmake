@@ -0,0 +1,44 @@
+# Turns every file in SHADER_DIR into a constexpr character table inside OUTPUT.
+# Run in script mode: cmake -DSHADER_DIR=<dir> -DOUTPUT=<file.cpp> -P EmbedShaders.cmake
+
+file(GLOB SHADER_FILES RELATIVE "${SHADER_DIR}" "${SHADER_DIR}/*")
+list(SORT SHADER_FILES)
+
+set(TABLES "")
+set(ENTRIES "")
+foreach(SHADER_FILE ${SHADER_FILES})
+	string(MAKE_C_IDENTIFIER "${SHADER_FILE}" IDENTIFIER)
+	# bytes instead of a string literal, so no source file can break the quoting
+	# and MSVC's string literal length limit never applies.
+	file(READ "${SHADER_DIR}/${SHADER_FILE}" CONTENTS HEX)
+	string(REGEX REPLACE "([0-9a-f][0-9a-f])" "'\\\\x\\1', " CONTENTS "${CONTENTS}")
+	string(APPEND TABLES "    constexpr char k_${IDENTIFIER}[] { ${CONTENTS}'\\0' };\n")
+	string(APPEND ENTRIES "        { \"${SHADER_FILE}\", { k_${IDENTIFIER}, sizeof(k_${IDENTIFIER}) - 1 } },\n")
+endforeach()
+
+list(LENGTH SHADER_FILES COUNT)
+set(GENERATED "// Generated by EmbedShaders.cmake from the shader directory. Do not edit.
+#include \"EmbeddedShaders.h\"
+
+#include <array>
+
+namespace {
+${TABLES}
+    constexpr std::array<EmbeddedShaders::File, ${COUNT}> kFiles { {
+${ENTRIES}    } };
+}
+
+namespace EmbeddedShaders {
+    std::span<const File> files() {
+        return kFiles;
+    }
+}
+")
+
+# only touch the output when it changed, so an unrelated reconfigure does not relink everything.
+if (EXISTS "${OUTPUT}")
+	file(READ "${OUTPUT}" PREVIOUS)
+endif()
+if (NOT "${PREVIOUS}" STREQUAL "${GENERATED}")
+	file(WRITE "${OUTPUT}" "${GENERATED}")
+endif()
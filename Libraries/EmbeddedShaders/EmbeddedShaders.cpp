@@ -0,0 +1,17 @@
+#include "EmbeddedShaders.h"
+
+#include <algorithm>
+#include <iostream>
+
+namespace EmbeddedShaders {
+    std::string_view find(std::string_view name) {
+        const auto table { files() };
+        const auto it { std::lower_bound(table.begin(), table.end(), name,
+            [](const File& file, std::string_view key) { return file.name < key; }) };
+        if (it == table.end() || it->name != name) {
+            std::cout << "ERROR::EMBEDDED_SHADERS::NOT_FOUND: " << name << std::endl;
+            return {};
+        }
+        return it->source;
+    }
+}
@@ -0,0 +1,22 @@
+#pragma once
+
+#include <span>
+#include <string_view>
+
+// Sources from Misc/Shaders compiled into the executable, so loading a shader
+// needs no file system access and no working directory assumptions.
+namespace EmbeddedShaders {
+    struct File {
+        std::string_view name;
+        std::string_view source;
+    };
+
+    // every embedded file, sorted by name.
+    // ------------------------------------------------------------------------
+    std::span<const File> files();
+
+    // source of a file by its name inside Misc/Shaders (e.g. "texture.vert"),
+    // or an empty view, reported as an error, when nothing with that name was embedded.
+    // ------------------------------------------------------------------------
+    std::string_view find(std::string_view name);
+}
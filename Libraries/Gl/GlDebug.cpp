@@ -0,0 +1,102 @@
+#include "GlDebug.h"
+
+#ifndef NDEBUG
+
+#include <iostream>
+
+#include <glad/glad.h>
+
+namespace {
+    struct CallSite {
+        const char* call {};
+        const char* file {};
+        int line {};
+    };
+
+    // the GLCHECK in progress on this thread, if any. GL calls run on the context thread, and
+    // synchronous debug output calls back on it before the GL function returns.
+    thread_local CallSite sCurrentCall {};
+    bool sCallbackActive {};
+
+    const char* errorName(GLenum error) {
+        switch (error) {
+        case GL_INVALID_ENUM: return "INVALID_ENUM";
+        case GL_INVALID_VALUE: return "INVALID_VALUE";
+        case GL_INVALID_OPERATION: return "INVALID_OPERATION";
+        case GL_INVALID_FRAMEBUFFER_OPERATION: return "INVALID_FRAMEBUFFER_OPERATION";
+        case GL_OUT_OF_MEMORY: return "OUT_OF_MEMORY";
+        default: return "UNKNOWN_ERROR";
+        }
+    }
+
+    const char* typeName(GLenum type) {
+        switch (type) {
+        case GL_DEBUG_TYPE_ERROR: return "ERROR";
+        case GL_DEBUG_TYPE_DEPRECATED_BEHAVIOR: return "DEPRECATED_BEHAVIOR";
+        case GL_DEBUG_TYPE_UNDEFINED_BEHAVIOR: return "UNDEFINED_BEHAVIOR";
+        case GL_DEBUG_TYPE_PORTABILITY: return "PORTABILITY";
+        case GL_DEBUG_TYPE_PERFORMANCE: return "PERFORMANCE";
+        default: return "OTHER";
+        }
+    }
+
+    void printCallSite(const CallSite& site) {
+        if (site.call != nullptr) {
+            std::cout << "\n  at " << site.file << ":" << site.line << " in " << site.call;
+        }
+    }
+
+    void APIENTRY debugCallback(GLenum /*source*/, GLenum type, GLuint id, GLenum severity, GLsizei /*length*/,
+                                const GLchar* message, const void* /*userParam*/) {
+        std::cout << "ERROR::GL::" << typeName(type) << " (id " << id << ", severity "
+                  << (severity == GL_DEBUG_SEVERITY_HIGH ? "high" : severity == GL_DEBUG_SEVERITY_MEDIUM ? "medium" : "low")
+                  << "): " << message;
+        printCallSite(sCurrentCall);
+        std::cout << std::endl;
+    }
+}
+
+namespace GlDebug {
+    void enable() {
+        if (!GLAD_GL_VERSION_4_3 && !GLAD_GL_KHR_debug) {
+            std::cout << "GL debug output unavailable, checking glGetError after every GLCHECK" << std::endl;
+            return;
+        }
+        glEnable(GL_DEBUG_OUTPUT);
+        // report inside the failing call, so sCurrentCall still names it.
+        glEnable(GL_DEBUG_OUTPUT_SYNCHRONOUS);
+        glDebugMessageCallback(debugCallback, nullptr);
+        // notifications (buffer placement and the like) are not problems.
+        glDebugMessageControl(GL_DONT_CARE, GL_DONT_CARE, GL_DEBUG_SEVERITY_NOTIFICATION, 0, nullptr, GL_FALSE);
+        sCallbackActive = true;
+
+        int flags {};
+        glGetIntegerv(GL_CONTEXT_FLAGS, &flags);
+        if ((flags & GL_CONTEXT_FLAG_DEBUG_BIT) == 0) {
+            std::cout << "GL context is not a debug context, the driver may report few or no messages" << std::endl;
+        }
+    }
+
+    bool callbackActive() {
+        return sCallbackActive;
+    }
+
+    ScopedCall::ScopedCall(const char* call, const char* file, int line) : mCall { call }, mFile { file }, mLine { line } {
+        sCurrentCall = { call, file, line };
+    }
+
+    ScopedCall::~ScopedCall() {
+        sCurrentCall = {};
+        if (sCallbackActive) {
+            return;
+        }
+        // several errors can be pending; glGetError returns one per call.
+        for (GLenum error { glGetError() }; error != GL_NO_ERROR; error = glGetError()) {
+            std::cout << "ERROR::GL::" << errorName(error);
+            printCallSite({ mCall, mFile, mLine });
+            std::cout << std::endl;
+        }
+    }
+}
+
+#endif
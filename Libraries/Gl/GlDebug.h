@@ -0,0 +1,53 @@
+#pragma once
+
+// GL error reporting for debug builds. With NDEBUG defined everything here compiles to
+// nothing: GLCHECK(call) is just call, and enable() is an empty inline function.
+//
+// Without NDEBUG, enable() installs a GL_KHR_debug message callback when the context offers
+// one (request a debug context, e.g. GLFW_OPENGL_DEBUG_CONTEXT, or most drivers stay quiet).
+// Messages are delivered synchronously, so the callback can name the GLCHECK call that
+// triggered them. Without KHR_debug every GLCHECK drains glGetError after its call instead.
+//
+//     GLCHECK(glBufferData(GL_ARRAY_BUFFER, size, data, GL_STATIC_DRAW));
+//     const auto location { GLCHECK(glGetUniformLocation(program, "model")) };
+//
+// Errors are printed as ERROR::GL::... with the call and its file and line.
+
+#ifdef NDEBUG
+
+namespace GlDebug {
+    inline void enable() {}
+}
+
+#define GLCHECK(call) (call)
+
+#else
+
+namespace GlDebug {
+    // call after the context is current and GL is loaded.
+    // ------------------------------------------------------------------------
+    void enable();
+    // true when errors arrive through the KHR_debug callback.
+    // ------------------------------------------------------------------------
+    bool callbackActive();
+
+    // marks the call being made on this thread for the duration of a GLCHECK expression.
+    class ScopedCall {
+    public:
+        ScopedCall(const char* call, const char* file, int line);
+        ScopedCall(const ScopedCall&) = delete;
+        ScopedCall& operator=(const ScopedCall&) = delete;
+        ~ScopedCall();
+
+    private:
+        const char* mCall {};
+        const char* mFile {};
+        int mLine {};
+    };
+}
+
+// the temporary lives until the end of the full expression, so its destructor runs after call
+// and the value of call is still the value of the whole expression.
+#define GLCHECK(call) (GlDebug::ScopedCall { #call, __FILE__, __LINE__ }, (call))
+
+#endif
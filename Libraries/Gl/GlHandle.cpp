@@ -0,0 +1,71 @@
+#include "GlHandle.h"
+#include "GlState.h"
+
+#include <glad/glad.h>
+
+unsigned int GlBufferTraits::create() {
+    unsigned int id {};
+    glGenBuffers(1, &id);
+    return id;
+}
+
+void GlBufferTraits::destroy(unsigned int id) {
+    GlState::shared().forgetBuffer(id);
+    glDeleteBuffers(1, &id);
+}
+
+unsigned int GlVertexArrayTraits::create() {
+    unsigned int id {};
+    glGenVertexArrays(1, &id);
+    return id;
+}
+
+void GlVertexArrayTraits::destroy(unsigned int id) {
+    GlState::shared().forgetVertexArray(id);
+    glDeleteVertexArrays(1, &id);
+}
+
+unsigned int GlTextureTraits::create() {
+    unsigned int id {};
+    glGenTextures(1, &id);
+    return id;
+}
+
+void GlTextureTraits::destroy(unsigned int id) {
+    GlState::shared().forgetTexture(id);
+    glDeleteTextures(1, &id);
+}
+
+unsigned int GlQueryTraits::create() {
+    unsigned int id {};
+    glGenQueries(1, &id);
+    return id;
+}
+
+void GlQueryTraits::destroy(unsigned int id) {
+    glDeleteQueries(1, &id);
+}
+
+unsigned int GlProgramPipelineTraits::create() {
+    unsigned int id {};
+    glGenProgramPipelines(1, &id);
+    return id;
+}
+
+void GlProgramPipelineTraits::destroy(unsigned int id) {
+    GlState::shared().forgetProgramPipeline(id);
+    glDeleteProgramPipelines(1, &id);
+}
+
+unsigned int GlProgramTraits::create() {
+    return glCreateProgram();
+}
+
+void GlProgramTraits::destroy(unsigned int id) {
+    GlState::shared().forgetProgram(id);
+    glDeleteProgram(id);
+}
+
+void GlShaderTraits::destroy(unsigned int id) {
+    glDeleteShader(id);
+}
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <utility>
+
+// Owner of one GL object name. Move-only, so exactly one handle deletes the object, and
+// classes holding handles can live in std::vector and be moved without touching the GPU.
+// Traits supplies the delete call, plus a create() for object types that need no arguments:
+//
+//     struct BufferTraits {
+//         static unsigned int create();          // glGenBuffers
+//         static void destroy(unsigned int id);  // glDeleteBuffers
+//     };
+//
+// Name 0 is "no object" for every GL type, so a default constructed handle owns nothing.
+// The traits below also tell GlState about the deletion, since GL recycles names.
+template <typename Traits>
+class GlHandle {
+public:
+    GlHandle() = default;
+    explicit GlHandle(unsigned int id) : mID { id } {}
+    GlHandle(const GlHandle&) = delete;
+    GlHandle& operator=(const GlHandle&) = delete;
+    GlHandle(GlHandle&& other) noexcept : mID { std::exchange(other.mID, 0u) } {}
+    GlHandle& operator=(GlHandle&& other) noexcept {
+        if (this != &other) {
+            reset(std::exchange(other.mID, 0u));
+        }
+        return *this;
+    }
+    ~GlHandle() { reset(); }
+
+    // a new object from Traits::create().
+    // ------------------------------------------------------------------------
+    static GlHandle create() { return GlHandle(Traits::create()); }
+
+    unsigned int get() const { return mID; }
+    explicit operator bool() const { return mID != 0; }
+
+    // delete the owned object, if any, and take over id.
+    // ------------------------------------------------------------------------
+    void reset(unsigned int id = 0) {
+        if (mID != 0) {
+            Traits::destroy(mID);
+        }
+        mID = id;
+    }
+    // give up ownership without deleting.
+    // ------------------------------------------------------------------------
+    unsigned int release() { return std::exchange(mID, 0u); }
+
+private:
+    unsigned int mID {};
+};
+
+struct GlBufferTraits {
+    static unsigned int create();
+    static void destroy(unsigned int id);
+};
+
+struct GlVertexArrayTraits {
+    static unsigned int create();
+    static void destroy(unsigned int id);
+};
+
+struct GlTextureTraits {
+    static unsigned int create();
+    static void destroy(unsigned int id);
+};
+
+struct GlQueryTraits {
+    static unsigned int create();
+    static void destroy(unsigned int id);
+};
+
+struct GlProgramPipelineTraits {
+    static unsigned int create();
+    static void destroy(unsigned int id);
+};
+
+struct GlProgramTraits {
+    static unsigned int create();
+    static void destroy(unsigned int id);
+};
+
+// shader objects need a type, so they are created with glCreateShader directly.
+struct GlShaderTraits {
+    static void destroy(unsigned int id);
+};
+
+using GlBuffer = GlHandle<GlBufferTraits>;
+using GlVertexArray = GlHandle<GlVertexArrayTraits>;
+using GlTexture = GlHandle<GlTextureTraits>;
+using GlQuery = GlHandle<GlQueryTraits>;
+using GlProgramPipeline = GlHandle<GlProgramPipelineTraits>;
+using GlProgram = GlHandle<GlProgramTraits>;
+using GlShader = GlHandle<GlShaderTraits>;
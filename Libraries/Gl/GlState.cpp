@@ -0,0 +1,205 @@
+#include "GlState.h"
+#include "GlDebug.h"
+
+#include <glad/glad.h>
+
+namespace {
+    // slot of a shadowed buffer target, or -1.
+    int bufferTargetIndex(unsigned int target) {
+        switch (target) {
+        case GL_ARRAY_BUFFER: return 0;
+        case GL_ELEMENT_ARRAY_BUFFER: return 1;
+        case GL_UNIFORM_BUFFER: return 2;
+        case GL_COPY_READ_BUFFER: return 3;
+        case GL_COPY_WRITE_BUFFER: return 4;
+        default: return -1;
+        }
+    }
+
+    // slot of a shadowed texture target, or -1.
+    int textureTargetIndex(unsigned int target) {
+        switch (target) {
+        case GL_TEXTURE_2D: return 0;
+        case GL_TEXTURE_2D_ARRAY: return 1;
+        case GL_TEXTURE_3D: return 2;
+        case GL_TEXTURE_CUBE_MAP: return 3;
+        default: return -1;
+        }
+    }
+
+    constexpr int kElementArrayBuffer { 1 };
+}
+
+GlState& GlState::shared() {
+    static GlState state;
+    return state;
+}
+
+GlState::GlState() {
+    invalidate();
+}
+
+void GlState::useProgram(unsigned int program) {
+    if (change(mProgram, program)) {
+        GLCHECK(glUseProgram(program));
+    }
+}
+
+void GlState::bindProgramPipeline(unsigned int pipeline) {
+    if (change(mProgramPipeline, pipeline)) {
+        GLCHECK(glBindProgramPipeline(pipeline));
+    }
+}
+
+void GlState::bindVertexArray(unsigned int vertexArray) {
+    if (change(mVertexArray, vertexArray)) {
+        GLCHECK(glBindVertexArray(vertexArray));
+        // each VAO has its own element array binding, which the shadow does not know.
+        mBuffers[kElementArrayBuffer] = kUnknown;
+    }
+}
+
+void GlState::bindBuffer(unsigned int target, unsigned int buffer) {
+    const int index { bufferTargetIndex(target) };
+    if (index < 0) {
+        mCounters.issued++;
+        GLCHECK(glBindBuffer(target, buffer));
+        return;
+    }
+    if (change(mBuffers[index], buffer)) {
+        GLCHECK(glBindBuffer(target, buffer));
+    }
+}
+
+void GlState::bindBufferBase(unsigned int target, unsigned int index, unsigned int buffer) {
+    mCounters.issued++;
+    GLCHECK(glBindBufferBase(target, index, buffer));
+    const int targetIndex { bufferTargetIndex(target) };
+    if (targetIndex >= 0) {
+        mBuffers[targetIndex] = buffer;
+    }
+}
+
+void GlState::bindTexture(unsigned int unit, unsigned int target, unsigned int texture) {
+    const int targetIndex { textureTargetIndex(target) };
+    const bool shadowed { unit < kTextureUnits && targetIndex >= 0 };
+    if (shadowed && mTextures[unit][targetIndex] == texture) {
+        mCounters.skipped++;
+        return;
+    }
+    if (change(mActiveTextureUnit, unit)) {
+        GLCHECK(glActiveTexture(GL_TEXTURE0 + unit));
+    }
+    mCounters.issued++;
+    GLCHECK(glBindTexture(target, texture));
+    if (shadowed) {
+        mTextures[unit][targetIndex] = texture;
+    }
+}
+
+void GlState::setBlend(bool enabled) {
+    setCapability(mBlend, GL_BLEND, enabled);
+}
+
+void GlState::setBlendFunc(unsigned int source, unsigned int destination) {
+    // both factors are compared, so count the pair as one call.
+    if (mBlendSource == source && mBlendDestination == destination) {
+        mCounters.skipped++;
+        return;
+    }
+    mCounters.issued++;
+    mBlendSource = source;
+    mBlendDestination = destination;
+    GLCHECK(glBlendFunc(source, destination));
+}
+
+void GlState::setDepthTest(bool enabled) {
+    setCapability(mDepthTest, GL_DEPTH_TEST, enabled);
+}
+
+void GlState::setDepthFunc(unsigned int function) {
+    if (change(mDepthFunc, function)) {
+        GLCHECK(glDepthFunc(function));
+    }
+}
+
+void GlState::setDepthMask(bool enabled) {
+    if (change(mDepthMask, enabled)) {
+        GLCHECK(glDepthMask(enabled ? GL_TRUE : GL_FALSE));
+    }
+}
+
+void GlState::forgetProgram(unsigned int program) {
+    // a deleted program stays current until another one is used, but its name may come back.
+    if (mProgram == program) {
+        mProgram = kUnknown;
+    }
+}
+
+void GlState::forgetProgramPipeline(unsigned int pipeline) {
+    if (mProgramPipeline == pipeline) {
+        mProgramPipeline = 0;
+    }
+}
+
+void GlState::forgetVertexArray(unsigned int vertexArray) {
+    if (mVertexArray == vertexArray) {
+        mVertexArray = 0;
+        mBuffers[kElementArrayBuffer] = kUnknown;
+    }
+}
+
+void GlState::forgetBuffer(unsigned int buffer) {
+    for (auto& binding : mBuffers) {
+        if (binding == buffer) {
+            binding = 0;
+        }
+    }
+}
+
+void GlState::forgetTexture(unsigned int texture) {
+    for (auto& unit : mTextures) {
+        for (auto& binding : unit) {
+            if (binding == texture) {
+                binding = 0;
+            }
+        }
+    }
+}
+
+void GlState::invalidate() {
+    mProgram = kUnknown;
+    mProgramPipeline = kUnknown;
+    mVertexArray = kUnknown;
+    mBuffers.fill(kUnknown);
+    mActiveTextureUnit = kUnknown;
+    for (auto& unit : mTextures) {
+        unit.fill(kUnknown);
+    }
+    mBlend = kUnknown;
+    mBlendSource = kUnknown;
+    mBlendDestination = kUnknown;
+    mDepthTest = kUnknown;
+    mDepthFunc = kUnknown;
+    mDepthMask = kUnknown;
+}
+
+bool GlState::change(unsigned int& shadow, unsigned int value) {
+    if (shadow == value) {
+        mCounters.skipped++;
+        return false;
+    }
+    mCounters.issued++;
+    shadow = value;
+    return true;
+}
+
+void GlState::setCapability(unsigned int& shadow, unsigned int capability, bool enabled) {
+    if (change(shadow, enabled)) {
+        if (enabled) {
+            GLCHECK(glEnable(capability));
+        } else {
+            GLCHECK(glDisable(capability));
+        }
+    }
+}
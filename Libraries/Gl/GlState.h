@@ -0,0 +1,91 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+
+// Shadow copy of the GL binding and fixed function state that draws change most often.
+// Every call compares against the shadow first and only reaches the driver when the value
+// actually changes; skipped calls are counted, see counters().
+//
+// This only works if all binds of the tracked state go through here. Code that calls GL
+// directly (or a library that does) has to call invalidate() afterwards. One instance per
+// process, matching the single GL context the programs here use.
+class GlState {
+public:
+    struct Counters {
+        size_t issued {};
+        size_t skipped {};
+    };
+
+    static GlState& shared();
+
+    // ------------------------------------------------------------------------
+    void useProgram(unsigned int program);
+    void bindProgramPipeline(unsigned int pipeline);
+    // binding a VAO also switches the element array buffer, which is part of VAO state.
+    // ------------------------------------------------------------------------
+    void bindVertexArray(unsigned int vertexArray);
+    // GL_ARRAY_BUFFER, GL_ELEMENT_ARRAY_BUFFER, GL_UNIFORM_BUFFER and GL_COPY_READ/WRITE_BUFFER
+    // are shadowed; other targets are always passed through.
+    // ------------------------------------------------------------------------
+    void bindBuffer(unsigned int target, unsigned int buffer);
+    // glBindBufferBase, which also sets the generic binding of target. indexed bindings
+    // themselves are not shadowed.
+    // ------------------------------------------------------------------------
+    void bindBufferBase(unsigned int target, unsigned int index, unsigned int buffer);
+    // bind a texture to a unit (0 based), switching the active unit only when needed.
+    // 2D, 2D array, 3D and cube map targets on the first kTextureUnits units are shadowed.
+    // ------------------------------------------------------------------------
+    void bindTexture(unsigned int unit, unsigned int target, unsigned int texture);
+    // ------------------------------------------------------------------------
+    void setBlend(bool enabled);
+    void setBlendFunc(unsigned int source, unsigned int destination);
+    void setDepthTest(bool enabled);
+    void setDepthFunc(unsigned int function);
+    void setDepthMask(bool enabled);
+
+    // called by GlHandle before an object is deleted. GL unbinds deleted buffers, textures and
+    // VAOs from the current context, and the shadow has to follow, or a new object that gets
+    // the recycled name would be taken as already bound.
+    // ------------------------------------------------------------------------
+    void forgetProgram(unsigned int program);
+    void forgetProgramPipeline(unsigned int pipeline);
+    void forgetVertexArray(unsigned int vertexArray);
+    void forgetBuffer(unsigned int buffer);
+    void forgetTexture(unsigned int texture);
+
+    // mark every shadowed value unknown, so the next call of each kind reaches GL.
+    // ------------------------------------------------------------------------
+    void invalidate();
+
+    const Counters& counters() const { return mCounters; }
+    void resetCounters() { mCounters = {}; }
+
+private:
+    // a value no GL call ever sets, so the first comparison after invalidate() fails.
+    static constexpr unsigned int kUnknown { ~0u };
+    static constexpr size_t kTextureUnits { 16 };
+    static constexpr size_t kTextureTargets { 4 };
+    static constexpr size_t kBufferTargets { 5 };
+
+    unsigned int mProgram { kUnknown };
+    unsigned int mProgramPipeline { kUnknown };
+    unsigned int mVertexArray { kUnknown };
+    std::array<unsigned int, kBufferTargets> mBuffers {};
+    unsigned int mActiveTextureUnit { kUnknown };
+    std::array<std::array<unsigned int, kTextureTargets>, kTextureUnits> mTextures {};
+    unsigned int mBlend { kUnknown };
+    unsigned int mBlendSource { kUnknown };
+    unsigned int mBlendDestination { kUnknown };
+    unsigned int mDepthTest { kUnknown };
+    unsigned int mDepthFunc { kUnknown };
+    unsigned int mDepthMask { kUnknown };
+    Counters mCounters {};
+
+    GlState();
+
+    // compare and record; true when the GL call has to be made.
+    // ------------------------------------------------------------------------
+    bool change(unsigned int& shadow, unsigned int value);
+    void setCapability(unsigned int& shadow, unsigned int capability, bool enabled);
+};
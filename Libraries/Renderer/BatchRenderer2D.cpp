@@ -0,0 +1,129 @@
+#include "BatchRenderer2D.h"
+
+#include <GlDebug.h>
+#include <GlState.h>
+
+#include <algorithm>
+#include <iostream>
+
+#include <glad/glad.h>
+
+namespace {
+    // batches per stream region, so a region only runs out after several full batches.
+    constexpr size_t kBatchesPerRegion { 4 };
+
+    constexpr std::array<unsigned int, 3> kTriangleIndices { 0, 1, 2 };
+    constexpr std::array<unsigned int, 6> kQuadIndices { 0, 1, 3,
+                                                         1, 2, 3 };
+}
+
+const VertexLayout BatchRenderer2D::kLayout { VertexLayout::of<Vertex>({
+    VertexLayout::attribute("aPos", &Vertex::pos),
+    VertexLayout::attribute("aColor", &Vertex::color),
+    VertexLayout::attribute("aTexCoord", &Vertex::tex) }) };
+
+BatchRenderer2D::BatchRenderer2D(size_t maxVertices, size_t maxIndices)
+    : mVertices { kBatchesPerRegion * maxVertices * sizeof(Vertex) }, mIndices { kBatchesPerRegion * maxIndices * sizeof(unsigned int) },
+      mVertexArrays { kLayout, mVertices.buffer(), mIndices.buffer() }, mMaxVertices { maxVertices }, mMaxIndices { maxIndices } {}
+
+void BatchRenderer2D::draw(Shader& shader, const TextureSet& textures, std::span<const Vertex> vertices, std::span<const unsigned int> indices,
+                           const glm::mat4& model) {
+    if (vertices.size() > mMaxVertices || indices.size() > mMaxIndices) {
+        std::cout << "ERROR::BATCH_RENDERER::SHAPE_TOO_LARGE: " << vertices.size() << " vertices and " << indices.size()
+                  << " indices, a batch holds " << mMaxVertices << " and " << mMaxIndices << std::endl;
+        return;
+    }
+    if (mVertexData != nullptr && (mShader != &shader || mTextures != textures)) {
+        flush();
+        mStats.stateFlushes++;
+    }
+    if (mVertexData != nullptr && (mVertexCount + vertices.size() > mVertexCapacity || mIndexCount + indices.size() > mIndexCapacity)) {
+        flush();
+        mStats.fullFlushes++;
+    }
+    if (mVertexData == nullptr) {
+        open(vertices.size(), indices.size());
+        if (mVertexData == nullptr) {
+            return;
+        }
+        mShader = &shader;
+        mTextures = textures;
+    }
+
+    // mapped memory may be write combined: write every element once, in order, and never read it back.
+    Vertex* vertexOut { mVertexData + mVertexCount };
+    for (const auto& vertex : vertices) {
+        *vertexOut++ = { glm::vec3(model * glm::vec4(vertex.pos, 1.0f)), vertex.color, vertex.tex };
+    }
+    unsigned int* indexOut { mIndexData + mIndexCount };
+    for (const auto index : indices) {
+        *indexOut++ = static_cast<unsigned int>(mVertexCount) + index;
+    }
+    mVertexCount += vertices.size();
+    mIndexCount += indices.size();
+    mStats.shapes++;
+}
+
+void BatchRenderer2D::drawTriangle(Shader& shader, const TextureSet& textures, const std::array<Vertex, 3>& vertices, const glm::mat4& model) {
+    draw(shader, textures, vertices, kTriangleIndices, model);
+}
+
+void BatchRenderer2D::drawQuad(Shader& shader, const TextureSet& textures, const std::array<Vertex, 4>& vertices, const glm::mat4& model) {
+    draw(shader, textures, vertices, kQuadIndices, model);
+}
+
+void BatchRenderer2D::flush() {
+    if (mVertexData == nullptr) {
+        return;
+    }
+    const size_t vertexOffset { mVertices.commit(mVertexCount * sizeof(Vertex)) };
+    const size_t indexOffset { mIndices.commit(mIndexCount * sizeof(unsigned int)) };
+    const size_t indexCount { mIndexCount };
+    mVertexData = nullptr;
+    mIndexData = nullptr;
+    mVertexCount = 0;
+    mIndexCount = 0;
+
+    mShader->use();
+    mShader->set<RenderQueue::ModelUniform>(glm::mat4(1.0f));
+    auto& state { GlState::shared() };
+    for (unsigned int unit = 0; unit < RenderQueue::kMaxTextures; unit++) {
+        if (mTextures[unit] != 0) {
+            state.bindTexture(unit, GL_TEXTURE_2D, mTextures[unit]);
+        }
+    }
+    mVertexArrays.bind(*mShader);
+    // indices count from the batch's first vertex, wherever in the buffer that landed.
+    GLCHECK(glDrawElementsBaseVertex(GL_TRIANGLES, static_cast<GLsizei>(indexCount), GL_UNSIGNED_INT, reinterpret_cast<const void*>(indexOffset),
+                                     static_cast<GLint>(vertexOffset / sizeof(Vertex))));
+    mStats.draws++;
+}
+
+void BatchRenderer2D::endFrame() {
+    flush();
+    mVertices.endFrame();
+    mIndices.endFrame();
+}
+
+void BatchRenderer2D::open(size_t vertices, size_t indices) {
+    for (int attempt = 0; attempt < 2; attempt++) {
+        // every commit is a whole number of elements, so the stream cursors stay aligned.
+        mVertexCapacity = std::min(mMaxVertices, mVertices.remaining() / sizeof(Vertex));
+        mIndexCapacity = std::min(mMaxIndices, mIndices.remaining() / sizeof(unsigned int));
+        if (mVertexCapacity >= vertices && mIndexCapacity >= indices) {
+            mVertexData = static_cast<Vertex*>(mVertices.map(mVertexCapacity * sizeof(Vertex), sizeof(Vertex)));
+            mIndexData = static_cast<unsigned int*>(mIndices.map(mIndexCapacity * sizeof(unsigned int), sizeof(unsigned int)));
+            if (mVertexData == nullptr || mIndexData == nullptr) {
+                std::cout << "ERROR::BATCH_RENDERER::STREAM_MAP_FAILED" << std::endl;
+                mVertices.endFrame();
+                mIndices.endFrame();
+                mVertexData = nullptr;
+                mIndexData = nullptr;
+            }
+            return;
+        }
+        // this frame's regions are used up; fence them and continue in the next ones.
+        mVertices.endFrame();
+        mIndices.endFrame();
+    }
+}
@@ -0,0 +1,102 @@
+#pragma once
+
+#include "RenderQueue.h"
+#include "StreamBuffer.h"
+#include "VertexArrayCache.h"
+
+#include <Shader.h>
+
+#include <glm/glm.hpp>
+
+#include <array>
+#include <cstddef>
+#include <span>
+
+// Many small shapes drawn with one glDrawElementsBaseVertex instead of one draw each.
+// Shapes are transformed on the CPU and appended to a batch in a pair of StreamBuffers;
+// the batch is issued when the next shape needs a different program or texture set, when
+// it would not fit, or on flush() and endFrame():
+//
+//     for (const auto& sprite : sprites) {
+//         batch.drawQuad(shader, { atlas }, sprite.vertices, sprite.model);
+//     }
+//     batch.endFrame();
+//
+// Consecutive shapes sharing state end up in the same batch, so sort them by program and
+// textures first when the order allows it. The shader's model uniform (RenderQueue::ModelUniform)
+// is set to identity for batches, since every vertex was already transformed by its shape's model.
+class BatchRenderer2D {
+public:
+    // attribute names match texture.vert.
+    struct Vertex {
+        glm::vec3 pos {};
+        glm::vec3 color {};
+        glm::vec2 tex {};
+    };
+
+    // textures[i] is bound to unit i as GL_TEXTURE_2D; 0 leaves the unit alone.
+    using TextureSet = std::array<unsigned int, RenderQueue::kMaxTextures>;
+
+    struct Stats {
+        size_t shapes {};
+        size_t draws {};
+        // batches issued because the program or texture set changed.
+        size_t stateFlushes {};
+        // batches issued because the next shape did not fit.
+        size_t fullFlushes {};
+    };
+
+    static const VertexLayout kLayout;
+
+    // the most vertices and indices a single batch can hold. each frame region of the
+    // streaming buffers fits several full batches, see StreamBuffer.
+    // ------------------------------------------------------------------------
+    explicit BatchRenderer2D(size_t maxVertices = 1 << 16, size_t maxIndices = 3 << 15);
+    BatchRenderer2D(const BatchRenderer2D&) = delete;
+    BatchRenderer2D& operator=(const BatchRenderer2D&) = delete;
+
+    // append a shape. vertices are transformed by model on the way in; indices count from
+    // the shape's first vertex and form GL_TRIANGLES.
+    // ------------------------------------------------------------------------
+    void draw(Shader& shader, const TextureSet& textures, std::span<const Vertex> vertices, std::span<const unsigned int> indices,
+              const glm::mat4& model = glm::mat4(1.0f));
+    // ------------------------------------------------------------------------
+    void drawTriangle(Shader& shader, const TextureSet& textures, const std::array<Vertex, 3>& vertices,
+                      const glm::mat4& model = glm::mat4(1.0f));
+    // vertices go around the quad, like Rectangle's: the triangles are 0, 1, 3 and 1, 2, 3.
+    // ------------------------------------------------------------------------
+    void drawQuad(Shader& shader, const TextureSet& textures, const std::array<Vertex, 4>& vertices,
+                  const glm::mat4& model = glm::mat4(1.0f));
+
+    // issue the pending batch, if any.
+    // ------------------------------------------------------------------------
+    void flush();
+    // flush and hand the frame's stream regions back to the GPU. call once per frame.
+    // ------------------------------------------------------------------------
+    void endFrame();
+
+    // totals since construction or the last resetStats().
+    const Stats& stats() const { return mStats; }
+    void resetStats() { mStats = {}; }
+
+private:
+    StreamBuffer mVertices;
+    StreamBuffer mIndices;
+    VertexArrayCache mVertexArrays;
+    size_t mMaxVertices {};
+    size_t mMaxIndices {};
+
+    // state of the open batch; mVertexData is nullptr while no batch is open.
+    Shader* mShader {};
+    TextureSet mTextures {};
+    Vertex* mVertexData {};
+    unsigned int* mIndexData {};
+    size_t mVertexCapacity {};
+    size_t mIndexCapacity {};
+    size_t mVertexCount {};
+    size_t mIndexCount {};
+    Stats mStats {};
+
+    // ------------------------------------------------------------------------
+    void open(size_t vertices, size_t indices);
+};
@@ -0,0 +1,73 @@
+#include "CommandBuffer.h"
+
+#include <algorithm>
+
+void CommandList::draw(const RenderQueue::Draw& draw, unsigned int layer, float depth) {
+    mCommands.push_back({ draw, layer, depth });
+}
+
+CommandBuffer::CommandBuffer(size_t threads) : mLists(std::max<size_t>(threads, 1)) {
+    for (size_t i = 1; i < mLists.size(); i++) {
+        mWorkers.emplace_back([this, i](std::stop_token stopToken) { work(stopToken, i); });
+    }
+}
+
+CommandBuffer::~CommandBuffer() {
+    // jthread requests the stop, which wakes the workers, and joins them.
+    mWorkers.clear();
+}
+
+void CommandBuffer::record(size_t count, const Recorder& recorder) {
+    {
+        std::lock_guard lock { mMutex };
+        mRecorder = &recorder;
+        mCount = count;
+        mRemaining = mWorkers.size();
+        mGeneration++;
+    }
+    mWake.notify_all();
+
+    // list 0 is recorded here instead of leaving this thread idle.
+    recordRange(0);
+
+    std::unique_lock lock { mMutex };
+    mDone.wait(lock, [this] { return mRemaining == 0; });
+    mRecorder = nullptr;
+}
+
+void CommandBuffer::submit(RenderQueue& queue) {
+    for (auto& list : mLists) {
+        for (const auto& command : list.mCommands) {
+            queue.submit(command.draw, command.layer, command.depth);
+        }
+        list.clear();
+    }
+}
+
+void CommandBuffer::work(std::stop_token stopToken, size_t index) {
+    size_t generation {};
+    while (true) {
+        {
+            std::unique_lock lock { mMutex };
+            if (!mWake.wait(lock, stopToken, [&] { return mGeneration != generation; })) {
+                return;
+            }
+            generation = mGeneration;
+        }
+        recordRange(index);
+        {
+            std::lock_guard lock { mMutex };
+            mRemaining--;
+        }
+        mDone.notify_one();
+    }
+}
+
+void CommandBuffer::recordRange(size_t index) {
+    const size_t lists { mLists.size() };
+    const size_t first { mCount * index / lists };
+    const size_t last { mCount * (index + 1) / lists };
+    if (first < last) {
+        (*mRecorder)(mLists[index], first, last);
+    }
+}
@@ -0,0 +1,89 @@
+#pragma once
+
+#include "RenderQueue.h"
+
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <stop_token>
+#include <thread>
+#include <vector>
+
+// Draws recorded by one thread. Recording only appends to a plain vector and never calls
+// GL, so any thread can do it; the vector keeps its capacity between frames.
+class CommandList {
+public:
+    // same arguments as RenderQueue::submit.
+    // ------------------------------------------------------------------------
+    void draw(const RenderQueue::Draw& draw, unsigned int layer = 0, float depth = 0.0f);
+
+    size_t size() const { return mCommands.size(); }
+    void clear() { mCommands.clear(); }
+
+private:
+    friend class CommandBuffer;
+
+    struct Command {
+        RenderQueue::Draw draw;
+        unsigned int layer {};
+        float depth {};
+    };
+
+    std::vector<Command> mCommands;
+};
+
+// One CommandList per recording thread, merged into a RenderQueue on the thread that owns
+// the GL context:
+//
+//     commandBuffer.record(objects.size(), [&](CommandList& list, size_t first, size_t last) {
+//         for (size_t i = first; i < last; i++) {
+//             objects[i].draw(list, shader);   // worker threads, no GL
+//         }
+//     });
+//     commandBuffer.submit(renderQueue);       // context thread
+//     renderQueue.flush();
+//
+// Lists are merged in index order and the queue sort is stable, so the result does not
+// depend on how the threads were scheduled.
+class CommandBuffer {
+public:
+    // records into the lists [first, last) of items. called on a worker thread, so it must not touch GL.
+    using Recorder = std::function<void(CommandList& list, size_t first, size_t last)>;
+
+    // one list per thread; threads - 1 workers are started, the caller of record() is the last one.
+    // ------------------------------------------------------------------------
+    explicit CommandBuffer(size_t threads = std::thread::hardware_concurrency());
+    CommandBuffer(const CommandBuffer&) = delete;
+    CommandBuffer& operator=(const CommandBuffer&) = delete;
+    ~CommandBuffer();
+
+    // split count items evenly over the lists and record them in parallel. returns once every
+    // list is recorded.
+    // ------------------------------------------------------------------------
+    void record(size_t count, const Recorder& recorder);
+    // record from the calling thread directly, e.g. for the few draws not worth a parallel pass.
+    // ------------------------------------------------------------------------
+    CommandList& list(size_t index) { return mLists[index]; }
+    size_t listCount() const { return mLists.size(); }
+
+    // queue every recorded draw, in list order, and empty the lists. GL context thread only.
+    // ------------------------------------------------------------------------
+    void submit(RenderQueue& queue);
+
+private:
+    std::vector<CommandList> mLists;
+    std::vector<std::jthread> mWorkers;
+
+    // the current record() call; workers start on a new generation and count down mRemaining.
+    std::mutex mMutex;
+    std::condition_variable_any mWake;
+    std::condition_variable mDone;
+    const Recorder* mRecorder {};
+    size_t mCount {};
+    size_t mGeneration {};
+    size_t mRemaining {};
+
+    void work(std::stop_token stopToken, size_t index);
+    void recordRange(size_t index);
+};
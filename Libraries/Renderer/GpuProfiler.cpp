@@ -0,0 +1,208 @@
+#include "GpuProfiler.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <map>
+
+#include <glad/glad.h>
+
+namespace {
+    double milliseconds(std::chrono::steady_clock::duration duration) {
+        return std::chrono::duration<double, std::milli>(duration).count();
+    }
+
+    double elapsedMs(const std::vector<GlQuery>& queries, size_t begin, size_t end) {
+        GLuint64 beginNs {};
+        GLuint64 endNs {};
+        glGetQueryObjectui64v(queries[begin].get(), GL_QUERY_RESULT, &beginNs);
+        glGetQueryObjectui64v(queries[end].get(), GL_QUERY_RESULT, &endNs);
+        return static_cast<double>(endNs - beginNs) / 1.0e6;
+    }
+}
+
+GpuProfiler::Scope::Scope(GpuProfiler& profiler, size_t index) : mProfiler { profiler }, mIndex { index } {}
+
+GpuProfiler::Scope::~Scope() {
+    mProfiler.endScope(mIndex);
+}
+
+GpuProfiler::GpuProfiler(size_t latency, size_t history) : mSlots(std::max<size_t>(latency, 1)), mHistory { history } {}
+
+void GpuProfiler::beginFrame() {
+    // pick up whatever earlier frames the GPU has finished, oldest first, without waiting. untimed
+    // frames skip slots, so ring order is not frame order.
+    while (!mStallReadback) {
+        Slot* oldest {};
+        for (auto& slot : mSlots) {
+            if (slot.pending && (oldest == nullptr || slot.frame.number < oldest->frame.number)) {
+                oldest = &slot;
+            }
+        }
+        if (oldest == nullptr || !collect(*oldest)) {
+            break;
+        }
+    }
+
+    auto& slot { mSlots[mFrameNumber % mSlots.size()] };
+    // still pending means the GPU is a whole ring behind; timing this frame would have to wait,
+    // and the slot's queries and scopes still belong to the frame they were issued for.
+    if (slot.pending) {
+        mCurrent = nullptr;
+        mUntimedScopes.clear();
+        mScopes = &mUntimedScopes;
+    } else {
+        mCurrent = &slot;
+        slot.usedQueries = 0;
+        slot.scopes.clear();
+        slot.frame = {};
+        slot.frame.number = mFrameNumber;
+        mScopes = &slot.scopes;
+    }
+    mFrameBegin = Clock::now();
+    if (mCurrent != nullptr) {
+        if (!mCurrent->frameQuery) {
+            mCurrent->frameQuery = GlQuery::create();
+        }
+        glBeginQuery(GL_TIME_ELAPSED, mCurrent->frameQuery.get());
+    }
+}
+
+void GpuProfiler::endFrame() {
+    const double cpuMs { milliseconds(Clock::now() - mFrameBegin) };
+    if (mCurrent != nullptr) {
+        glEndQuery(GL_TIME_ELAPSED);
+        mCurrent->frame.cpuMs = cpuMs;
+        mCurrent->pending = true;
+    } else {
+        Frame frame {};
+        frame.number = mFrameNumber;
+        frame.cpuMs = cpuMs;
+        for (const auto& scope : mUntimedScopes) {
+            frame.scopes.push_back({ scope.name, scope.cpuMs });
+        }
+        pushFrame(std::move(frame));
+    }
+    mCurrent = nullptr;
+    mScopes = nullptr;
+    mFrameNumber++;
+}
+
+GpuProfiler::Scope GpuProfiler::scope(std::string name) {
+    if (mScopes == nullptr) {
+        return Scope(*this, kNoScope);
+    }
+    PendingScope scope { std::move(name) };
+    if (mCurrent != nullptr) {
+        scope.beginQuery = timestamp(*mCurrent);
+    }
+    scope.cpuBegin = Clock::now();
+    mScopes->push_back(std::move(scope));
+    return Scope(*this, mScopes->size() - 1);
+}
+
+void GpuProfiler::endScope(size_t index) {
+    if (index == kNoScope || mScopes == nullptr) {
+        return;
+    }
+    auto& scope { (*mScopes)[index] };
+    scope.cpuMs = milliseconds(Clock::now() - scope.cpuBegin);
+    if (mCurrent != nullptr) {
+        scope.endQuery = timestamp(*mCurrent);
+    }
+}
+
+size_t GpuProfiler::timestamp(Slot& slot) {
+    if (slot.usedQueries == slot.queries.size()) {
+        slot.queries.push_back(GlQuery::create());
+    }
+    glQueryCounter(slot.queries[slot.usedQueries].get(), GL_TIMESTAMP);
+    return slot.usedQueries++;
+}
+
+bool GpuProfiler::collect(Slot& slot) {
+    // queries finish in order, and the frame query ends after every scope's timestamp, so its
+    // result being ready means all of them are.
+    GLuint available {};
+    glGetQueryObjectuiv(slot.frameQuery.get(), GL_QUERY_RESULT_AVAILABLE, &available);
+    if (!available) {
+        return false;
+    }
+
+    auto& frame { slot.frame };
+    frame.hasGpuTimes = true;
+    GLuint64 frameNs {};
+    glGetQueryObjectui64v(slot.frameQuery.get(), GL_QUERY_RESULT, &frameNs);
+    frame.gpuMs = static_cast<double>(frameNs) / 1.0e6;
+    frame.scopes.clear();
+    for (const auto& scope : slot.scopes) {
+        frame.scopes.push_back({ scope.name, scope.cpuMs, elapsedMs(slot.queries, scope.beginQuery, scope.endQuery) });
+    }
+    pushFrame(std::move(frame));
+    slot.pending = false;
+    return true;
+}
+
+void GpuProfiler::pushFrame(Frame frame) {
+    mFrames.push_back(std::move(frame));
+    while (mFrames.size() > mHistory) {
+        mFrames.pop_front();
+    }
+}
+
+bool GpuProfiler::writeReport(const std::filesystem::path& path) const {
+    std::ofstream file(path, std::ios::trunc);
+    if (!file) {
+        std::cout << "ERROR::GPU_PROFILER::REPORT_NOT_SUCCESSFULLY_WRITTEN: " << path.string() << std::endl;
+        return false;
+    }
+
+    struct Average {
+        double cpuMs {};
+        double gpuMs {};
+        size_t cpuCount {};
+        size_t gpuCount {};
+    };
+    std::map<std::string, Average> averages;
+    size_t gpuBoundFrames {};
+
+    file << "{\n  \"frames\": [";
+    for (size_t i = 0; i < mFrames.size(); i++) {
+        const auto& frame { mFrames[i] };
+        if (frame.hasGpuTimes && frame.gpuMs > frame.cpuMs) {
+            gpuBoundFrames++;
+        }
+        file << (i == 0 ? "\n" : ",\n") << "    { \"frame\": " << frame.number << ", \"cpuMs\": " << frame.cpuMs;
+        if (frame.hasGpuTimes) {
+            file << ", \"gpuMs\": " << frame.gpuMs;
+        }
+        file << ", \"scopes\": [";
+        for (size_t j = 0; j < frame.scopes.size(); j++) {
+            const auto& scope { frame.scopes[j] };
+            file << (j == 0 ? " " : ", ") << "{ \"name\": \"" << scope.name << "\", \"cpuMs\": " << scope.cpuMs;
+            if (frame.hasGpuTimes) {
+                file << ", \"gpuMs\": " << scope.gpuMs;
+            }
+            file << " }";
+
+            auto& average { averages[scope.name] };
+            average.cpuMs += scope.cpuMs;
+            average.cpuCount++;
+            if (frame.hasGpuTimes) {
+                average.gpuMs += scope.gpuMs;
+                average.gpuCount++;
+            }
+        }
+        file << " ] }";
+    }
+    file << "\n  ],\n  \"gpuBoundFrames\": " << gpuBoundFrames << ",\n  \"averages\": [";
+    for (bool first { true }; const auto& [name, average] : averages) {
+        file << (first ? "\n" : ",\n") << "    { \"name\": \"" << name << "\", \"cpuMs\": "
+             << average.cpuMs / static_cast<double>(average.cpuCount) << ", \"gpuMs\": "
+             << (average.gpuCount > 0 ? average.gpuMs / static_cast<double>(average.gpuCount) : 0.0) << " }";
+        first = false;
+    }
+    file << "\n  ]\n}\n";
+    return static_cast<bool>(file);
+}
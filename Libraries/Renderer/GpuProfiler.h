@@ -0,0 +1,132 @@
+#pragma once
+
+#include <GlHandle.h>
+
+#include <chrono>
+#include <cstddef>
+#include <deque>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+// Per frame GPU and CPU times of named scopes. Scope boundaries are GL_TIMESTAMP queries
+// (glQueryCounter), so scopes may nest; the frame itself is one GL_TIME_ELAPSED query, which
+// counts the time the GPU spent on the frame's commands rather than the wall time between its
+// first and last one. Both still include any gaps in which the GPU waited for the CPU to
+// submit more work mid frame. Queries go into a ring of frame slots that is read
+// back frames later, and only once GL_QUERY_RESULT_AVAILABLE says so, so the render loop
+// never waits on the GPU:
+//
+//     profiler.beginFrame();
+//     {
+//         const auto scope { profiler.scope("rectangle") };
+//         renderQueue.flush();
+//     }
+//     profiler.endFrame();
+//
+// If the GPU falls so far behind that the oldest slot is still unfinished when it comes
+// around again, that frame gets CPU times only instead of a stall; the slot keeps its
+// queries and is read back once they are done. scope() outside beginFrame()/endFrame()
+// times nothing.
+class GpuProfiler {
+public:
+    struct Timing {
+        std::string name;
+        double cpuMs {};
+        double gpuMs {};
+    };
+
+    struct Frame {
+        size_t number {};
+        double cpuMs {};
+        double gpuMs {};
+        // false when the frame was recorded without queries, see above.
+        bool hasGpuTimes {};
+        std::vector<Timing> scopes;
+    };
+
+    // ends a scope when it goes out of scope.
+    class Scope {
+    public:
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+        ~Scope();
+
+    private:
+        friend class GpuProfiler;
+
+        Scope(GpuProfiler& profiler, size_t index);
+
+        GpuProfiler& mProfiler;
+        // kNoScope for a scope opened outside a frame.
+        size_t mIndex {};
+    };
+
+    // latency is the number of frames results may take to come back, and the ring size.
+    // history is how many finished frames are kept for frames() and the report.
+    // ------------------------------------------------------------------------
+    explicit GpuProfiler(size_t latency = 4, size_t history = 600);
+
+    // ------------------------------------------------------------------------
+    void beginFrame();
+    void endFrame();
+    // time the rest of the enclosing C++ scope on the CPU and the GPU.
+    // ------------------------------------------------------------------------
+    [[nodiscard]] Scope scope(std::string name);
+
+    // finished frames in the order their results came in. the newest is usually latency frames old.
+    // ------------------------------------------------------------------------
+    const std::deque<Frame>& frames() const { return mFrames; }
+    // while set, beginFrame() reads nothing back, so once the ring is full every frame takes
+    // the CPU times only path. for checking that path without a slow GPU.
+    // ------------------------------------------------------------------------
+    void stallReadback(bool stall) { mStallReadback = stall; }
+    // every kept frame plus per scope averages, and how many frames kept the GPU busy for
+    // longer than the CPU spent on them. returns false if the file could not be written.
+    // ------------------------------------------------------------------------
+    bool writeReport(const std::filesystem::path& path) const;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    static constexpr size_t kNoScope { static_cast<size_t>(-1) };
+
+    struct PendingScope {
+        std::string name;
+        size_t beginQuery {};
+        size_t endQuery {};
+        Clock::time_point cpuBegin {};
+        double cpuMs {};
+    };
+
+    // one frame's worth of queries; the query objects are reused every time the slot comes around.
+    struct Slot {
+        // GL_TIME_ELAPSED over the whole frame.
+        GlQuery frameQuery;
+        std::vector<GlQuery> queries;
+        size_t usedQueries {};
+        std::vector<PendingScope> scopes;
+        Frame frame;
+        // queries were issued and not read back yet. the slot is left alone until they are.
+        bool pending {};
+    };
+
+    std::vector<Slot> mSlots;
+    size_t mHistory {};
+    std::deque<Frame> mFrames;
+    size_t mFrameNumber {};
+    // slot timing the current frame, nullptr if it is untimed.
+    Slot* mCurrent {};
+    // scopes of the current frame: the slot's, or mUntimedScopes.
+    std::vector<PendingScope>* mScopes {};
+    std::vector<PendingScope> mUntimedScopes;
+    Clock::time_point mFrameBegin {};
+    bool mStallReadback {};
+
+    // ------------------------------------------------------------------------
+    size_t timestamp(Slot& slot);
+    void pushFrame(Frame frame);
+    void endScope(size_t index);
+    // read the slot back if the GPU is done with it; false if it is still busy.
+    bool collect(Slot& slot);
+};
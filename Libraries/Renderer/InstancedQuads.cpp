@@ -0,0 +1,115 @@
+#include "InstancedQuads.h"
+
+#include <GlDebug.h>
+#include <GlState.h>
+
+#include <iostream>
+
+#include <glad/glad.h>
+
+namespace {
+    // the vertices of Rectangle in LearningGL, as a unit square around the origin.
+    constexpr std::array<InstancedQuads::Vertex, 4> kQuadVertices { {
+        { glm::vec2(0.5f, 0.5f), glm::vec2(1.0f, 1.0f) },
+        { glm::vec2(0.5f, -0.5f), glm::vec2(1.0f, 0.0f) },
+        { glm::vec2(-0.5f, -0.5f), glm::vec2(0.0f, 0.0f) },
+        { glm::vec2(-0.5f, 0.5f), glm::vec2(0.0f, 1.0f) } } };
+    constexpr std::array<unsigned int, 6> kQuadIndices { 0, 1, 3,
+                                                         1, 2, 3 };
+
+    // sampler uniforms of instanced.frag
+    using Texture0Uniform = Uniform<"texture0", int>;
+    using Texture1Uniform = Uniform<"texture1", int>;
+    using Texture2Uniform = Uniform<"texture2", int>;
+    using Texture3Uniform = Uniform<"texture3", int>;
+
+    template <typename T, size_t N>
+    GlBuffer createStaticBuffer(GLenum target, const std::array<T, N>& data) {
+        auto buffer { GlBuffer::create() };
+        GlState::shared().bindBuffer(target, buffer.get());
+        GLCHECK(glBufferData(target, data.size() * sizeof(T), data.data(), GL_STATIC_DRAW));
+        return buffer;
+    }
+}
+
+const VertexLayout InstancedQuads::kVertexLayout { VertexLayout::of<Vertex>({
+    VertexLayout::attribute("aPos", &Vertex::pos),
+    VertexLayout::attribute("aTexCoord", &Vertex::tex) }) };
+
+const VertexLayout InstancedQuads::kInstanceLayout { VertexLayout::of<Instance>({
+    VertexLayout::attribute("aOffset", &Instance::position),
+    VertexLayout::attribute("aScale", &Instance::scale),
+    VertexLayout::attribute("aRotation", &Instance::rotation),
+    VertexLayout::attribute("aTextureIndex", &Instance::texture),
+    VertexLayout::attribute("aTint", &Instance::color) }, 1) };
+
+InstancedQuads::InstancedQuads(size_t maxInstances)
+    : mVertexBuffer { createStaticBuffer(GL_ARRAY_BUFFER, kQuadVertices) },
+      // uploaded through the copy target, so whichever VAO is bound keeps its element buffer.
+      mElementBuffer { createStaticBuffer(GL_COPY_WRITE_BUFFER, kQuadIndices) },
+      mBaseInstance { GLAD_GL_VERSION_4_2 || GLAD_GL_ARB_base_instance },
+      // without base instances the attributes have to start at offset 0, so every instances() call reuses the
+      // same bytes. orphaning gives each call fresh storage; a single fenced region would wait for the last draw.
+      mInstances { maxInstances * sizeof(Instance), 3, mBaseInstance ? StreamBuffer::Mode::Auto : StreamBuffer::Mode::Orphaning },
+      mVertexArrays { kVertexLayout, mVertexBuffer.get(), mElementBuffer.get(), kInstanceLayout, mInstances.buffer() },
+      mMaxInstances { maxInstances } {}
+
+std::span<InstancedQuads::Instance> InstancedQuads::instances(size_t count) {
+    if (count > mMaxInstances) {
+        std::cout << "ERROR::INSTANCED_QUADS::TOO_MANY_INSTANCES: " << count << ", drawing the first " << mMaxInstances << std::endl;
+        count = mMaxInstances;
+    }
+    if (!mBaseInstance) {
+        mInstances.endFrame();
+    }
+    void* data { mInstances.map(count * sizeof(Instance), sizeof(Instance)) };
+    if (data == nullptr) {
+        // earlier draws used up this frame's region; continue in the next one.
+        mInstances.endFrame();
+        data = mInstances.map(count * sizeof(Instance), sizeof(Instance));
+    }
+    mMapped = data != nullptr;
+    mCount = mMapped ? count : 0;
+    return { static_cast<Instance*>(data), mCount };
+}
+
+void InstancedQuads::draw(Shader& shader, const TextureSet& textures) {
+    if (!mMapped) {
+        return;
+    }
+    const size_t offset { mInstances.commit(mCount * sizeof(Instance)) };
+    mMapped = false;
+    if (mCount == 0) {
+        return;
+    }
+
+    shader.use();
+    shader.set<Texture0Uniform>(0);
+    shader.set<Texture1Uniform>(1);
+    shader.set<Texture2Uniform>(2);
+    shader.set<Texture3Uniform>(3);
+    auto& state { GlState::shared() };
+    for (unsigned int unit = 0; unit < RenderQueue::kMaxTextures; unit++) {
+        if (textures[unit] != 0) {
+            state.bindTexture(unit, GL_TEXTURE_2D, textures[unit]);
+        }
+    }
+    mVertexArrays.bind(shader);
+    const auto instanceCount { static_cast<GLsizei>(mCount) };
+    if (mBaseInstance) {
+        GLCHECK(glDrawElementsInstancedBaseInstance(GL_TRIANGLES, static_cast<GLsizei>(kQuadIndices.size()), GL_UNSIGNED_INT, nullptr,
+                                                    instanceCount, static_cast<GLuint>(offset / sizeof(Instance))));
+    } else {
+        GLCHECK(glDrawElementsInstanced(GL_TRIANGLES, static_cast<GLsizei>(kQuadIndices.size()), GL_UNSIGNED_INT, nullptr, instanceCount));
+    }
+}
+
+void InstancedQuads::endFrame() {
+    if (mMapped) {
+        mInstances.commit(0);
+        mMapped = false;
+    }
+    if (mBaseInstance) {
+        mInstances.endFrame();
+    }
+}
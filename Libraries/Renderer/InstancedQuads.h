@@ -0,0 +1,83 @@
+#pragma once
+
+#include "RenderQueue.h"
+#include "StreamBuffer.h"
+#include "VertexArrayCache.h"
+
+#include <GlHandle.h>
+#include <Shader.h>
+
+#include <glm/glm.hpp>
+
+#include <array>
+#include <cstddef>
+#include <span>
+
+// Many independently moving textured quads in one glDrawElementsInstanced. The quad itself
+// is a static unit square; everything that differs per quad is an Instance, written every
+// frame straight into a StreamBuffer and read with an attribute divisor of 1:
+//
+//     auto instances { quads.instances(count) };
+//     for (size_t i = 0; i < instances.size(); i++) {
+//         instances[i] = { positions[i], glm::vec2(0.02f), angles[i], 0.0f, glm::vec4(1.0f) };
+//     }
+//     quads.draw(shader, { texture1, texture2 });
+//     quads.endFrame();
+//
+// Meant for instanced.vert and instanced.frag: Instance::texture picks which of the four
+// texture units the quad samples, and the result is multiplied by Instance::color.
+class InstancedQuads {
+public:
+    // quad corners and texture coordinates; attribute names match instanced.vert.
+    struct Vertex {
+        glm::vec2 pos {};
+        glm::vec2 tex {};
+    };
+
+    // 40 bytes per quad. a 2D transform is all a quad needs, and far less than a mat4.
+    struct Instance {
+        glm::vec2 position {};
+        glm::vec2 scale { 1.0f };
+        // radians, about the quad center.
+        float rotation {};
+        // texture unit 0 to 3, as a float since instance attributes are float only.
+        float texture {};
+        glm::vec4 color { 1.0f };
+    };
+
+    // textures[i] is bound to unit i as GL_TEXTURE_2D; 0 leaves the unit alone.
+    using TextureSet = std::array<unsigned int, RenderQueue::kMaxTextures>;
+
+    static const VertexLayout kVertexLayout;
+    static const VertexLayout kInstanceLayout;
+
+    // maxInstances is the most quads a single draw() can hold.
+    // ------------------------------------------------------------------------
+    explicit InstancedQuads(size_t maxInstances = 1 << 17);
+    InstancedQuads(const InstancedQuads&) = delete;
+    InstancedQuads& operator=(const InstancedQuads&) = delete;
+
+    // room for count instances in GL memory, to be filled before the next draw(). mapped
+    // memory may be write combined: write every instance once and never read it back.
+    // count is capped at maxInstances.
+    // ------------------------------------------------------------------------
+    std::span<Instance> instances(size_t count);
+    // draw the instances of the last instances() call, all of them in one call.
+    // ------------------------------------------------------------------------
+    void draw(Shader& shader, const TextureSet& textures);
+    // hand the frame's instance region back to the GPU. call once per frame.
+    // ------------------------------------------------------------------------
+    void endFrame();
+
+private:
+    GlBuffer mVertexBuffer;
+    GlBuffer mElementBuffer;
+    // without glDrawElementsInstancedBaseInstance (GL 4.2) the instance attributes always start
+    // at offset 0 of the stream, so every instances() call starts a new frame of an orphaning stream.
+    bool mBaseInstance {};
+    StreamBuffer mInstances;
+    VertexArrayCache mVertexArrays;
+    size_t mMaxInstances {};
+    size_t mCount {};
+    bool mMapped {};
+};
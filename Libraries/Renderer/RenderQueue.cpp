@@ -0,0 +1,110 @@
+#include "RenderQueue.h"
+
+#include <GlDebug.h>
+#include <GlState.h>
+#include <ShaderHash.h>
+
+#include <algorithm>
+#include <string_view>
+
+#include <glad/glad.h>
+
+namespace {
+    constexpr int kLayerShift { 60 };
+    constexpr int kProgramShift { 48 };
+    constexpr int kTextureSetShift { 32 };
+    constexpr int kVertexArrayShift { 20 };
+
+    constexpr std::uint64_t kLayerLimit { (1ull << 4) - 1 };
+    constexpr std::uint64_t kProgramLimit { (1ull << 12) - 1 };
+    constexpr std::uint64_t kTextureSetLimit { (1ull << 16) - 1 };
+    constexpr std::uint64_t kVertexArrayLimit { (1ull << 12) - 1 };
+    constexpr std::uint64_t kDepthLimit { (1ull << 20) - 1 };
+
+    constexpr std::uint64_t field(std::uint64_t key, int shift, std::uint64_t limit) {
+        return (key >> shift) & limit;
+    }
+}
+
+void RenderQueue::submit(const Draw& draw, unsigned int layer, float depth) {
+    const std::string_view textureBytes { reinterpret_cast<const char*>(draw.textures.data()), sizeof(draw.textures) };
+    const std::uint64_t program { intern(mProgramIds, draw.shader->id(), kProgramLimit) };
+    const std::uint64_t textureSet { intern(mTextureSetIds, shaderHash(textureBytes), kTextureSetLimit) };
+    const std::uint64_t vertexArrays { intern<const VertexArrayCache*>(mVertexArrayIds, draw.vertexArrays, kVertexArrayLimit) };
+    const auto depthBits { static_cast<std::uint64_t>(std::clamp(depth, 0.0f, 1.0f) * kDepthLimit) };
+
+    const std::uint64_t key { (std::min<std::uint64_t>(layer, kLayerLimit) << kLayerShift) | (program << kProgramShift)
+                              | (textureSet << kTextureSetShift) | (vertexArrays << kVertexArrayShift) | depthBits };
+    mItems.push_back({ key, static_cast<std::uint32_t>(mDraws.size()) });
+    mDraws.push_back(draw);
+}
+
+void RenderQueue::flush() {
+    sort();
+
+    mStats = { mItems.size() };
+    auto& state { GlState::shared() };
+    for (size_t i = 0; i < mItems.size(); i++) {
+        const auto key { mItems[i].key };
+        if (i == 0 || field(key, kProgramShift, kProgramLimit) != field(mItems[i - 1].key, kProgramShift, kProgramLimit)) {
+            mStats.programChanges++;
+        }
+        if (i == 0 || field(key, kTextureSetShift, kTextureSetLimit) != field(mItems[i - 1].key, kTextureSetShift, kTextureSetLimit)) {
+            mStats.textureChanges++;
+        }
+        if (i == 0 || field(key, kVertexArrayShift, kVertexArrayLimit) != field(mItems[i - 1].key, kVertexArrayShift, kVertexArrayLimit)) {
+            mStats.vertexArrayChanges++;
+        }
+
+        const auto& draw { mDraws[mItems[i].index] };
+        draw.shader->use();
+        draw.shader->set<ModelUniform>(draw.model);
+        for (unsigned int unit = 0; unit < kMaxTextures; unit++) {
+            if (draw.textures[unit] != 0) {
+                state.bindTexture(unit, GL_TEXTURE_2D, draw.textures[unit]);
+            }
+        }
+        draw.vertexArrays->bind(*draw.shader);
+        if (draw.indexed) {
+            GLCHECK(glDrawElements(draw.mode, draw.count, GL_UNSIGNED_INT, reinterpret_cast<const void*>(draw.first * sizeof(unsigned int))));
+        } else {
+            GLCHECK(glDrawArrays(draw.mode, draw.first, draw.count));
+        }
+    }
+
+    mItems.clear();
+    mDraws.clear();
+    // ids only have to be consistent within one flush; numbering from zero again every frame
+    // keeps them inside their fields however many programs and textures come and go.
+    mProgramIds.clear();
+    mTextureSetIds.clear();
+    mVertexArrayIds.clear();
+}
+
+void RenderQueue::sort() {
+    // least significant digit radix sort, one byte per pass. stable, so equal keys keep
+    // their submission order; passes where every key has the same byte are skipped.
+    mScratch.resize(mItems.size());
+    for (int shift = 0; shift < 64; shift += 8) {
+        std::array<size_t, 257> offsets {};
+        for (const auto& item : mItems) {
+            offsets[((item.key >> shift) & 0xFF) + 1]++;
+        }
+        if (std::find(offsets.begin() + 1, offsets.end(), mItems.size()) != offsets.end()) {
+            continue;
+        }
+        for (size_t i = 1; i < offsets.size(); i++) {
+            offsets[i] += offsets[i - 1];
+        }
+        for (const auto& item : mItems) {
+            mScratch[offsets[(item.key >> shift) & 0xFF]++] = item;
+        }
+        mItems.swap(mScratch);
+    }
+}
+
+template <typename Key>
+std::uint64_t RenderQueue::intern(std::unordered_map<Key, std::uint64_t>& ids, const Key& key, std::uint64_t limit) {
+    const auto [it, inserted] { ids.try_emplace(key, std::min<std::uint64_t>(ids.size(), limit)) };
+    return it->second;
+}
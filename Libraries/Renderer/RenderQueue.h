@@ -0,0 +1,88 @@
+#pragma once
+
+#include "VertexArrayCache.h"
+
+#include <Shader.h>
+#include <Uniform.h>
+
+#include <glm/glm.hpp>
+
+#include <array>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+// Draws collected over a frame and issued in state order instead of submission order.
+// Each submitted draw becomes a 64 bit sort key plus the index of its payload:
+//
+//     bits 63..60  layer         drawn in ascending order, e.g. world before UI
+//     bits 59..48  program
+//     bits 47..32  texture set
+//     bits 31..20  vertex arrays
+//     bits 19..0   depth         front to back within equal state
+//
+// flush() radix sorts the keys and walks them, so draws sharing a program and textures
+// end up next to each other and GlState filters the binds between them. Programs, texture
+// sets and vertex arrays are numbered in the order the queue first sees them since the last
+// flush; ids beyond a field's range share its last value, which only costs grouping, never correctness.
+class RenderQueue {
+public:
+    static constexpr size_t kMaxTextures { 4 };
+
+    // set from Draw::model before every draw. programs without it ignore it, and the shader's
+    // uniform shadow skips the upload when consecutive draws share a transform.
+    using ModelUniform = Uniform<"model", glm::mat4>;
+
+    struct Draw {
+        Shader* shader {};
+        VertexArrayCache* vertexArrays {};
+        // textures[i] is bound to unit i as GL_TEXTURE_2D; 0 leaves the unit alone.
+        std::array<unsigned int, kMaxTextures> textures {};
+        // object to clip space, so moving an object changes this instead of its vertex buffer.
+        glm::mat4 model { 1.0f };
+        // GL_TRIANGLES unless set.
+        unsigned int mode { 0x0004 };
+        int first {};
+        int count {};
+        // glDrawElements with unsigned int indices instead of glDrawArrays.
+        bool indexed {};
+    };
+
+    struct Stats {
+        size_t draws {};
+        size_t programChanges {};
+        size_t textureChanges {};
+        size_t vertexArrayChanges {};
+    };
+
+    // queue a draw. layer is 0..15, depth is clamped to [0, 1].
+    // ------------------------------------------------------------------------
+    void submit(const Draw& draw, unsigned int layer = 0, float depth = 0.0f);
+    // sort and issue everything queued since the last flush, then empty the queue.
+    // ------------------------------------------------------------------------
+    void flush();
+
+    size_t size() const { return mItems.size(); }
+    // state changes of the last flush, after sorting.
+    const Stats& stats() const { return mStats; }
+
+private:
+    struct Item {
+        std::uint64_t key {};
+        std::uint32_t index {};
+    };
+
+    std::vector<Draw> mDraws;
+    std::vector<Item> mItems;
+    // second buffer for the radix passes, kept so sorting allocates nothing after the first frames.
+    std::vector<Item> mScratch;
+    std::unordered_map<unsigned int, std::uint64_t> mProgramIds;
+    std::unordered_map<std::uint64_t, std::uint64_t> mTextureSetIds;
+    std::unordered_map<const VertexArrayCache*, std::uint64_t> mVertexArrayIds;
+    Stats mStats {};
+
+    // ------------------------------------------------------------------------
+    void sort();
+    template <typename Key>
+    static std::uint64_t intern(std::unordered_map<Key, std::uint64_t>& ids, const Key& key, std::uint64_t limit);
+};
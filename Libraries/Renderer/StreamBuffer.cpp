@@ -0,0 +1,143 @@
+#include "StreamBuffer.h"
+
+#include <GlDebug.h>
+#include <GlState.h>
+
+#include <algorithm>
+#include <iostream>
+
+#include <glad/glad.h>
+
+namespace {
+    // mapping through the copy target never touches the element buffer binding of the bound VAO.
+    constexpr GLenum kMapTarget { GL_COPY_WRITE_BUFFER };
+    constexpr GLbitfield kPersistentFlags { GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT };
+    constexpr GLbitfield kOrphanFlags { GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT };
+    constexpr GLbitfield kAppendFlags { GL_MAP_WRITE_BIT | GL_MAP_UNSYNCHRONIZED_BIT | GL_MAP_INVALIDATE_RANGE_BIT };
+    // how long a single glClientWaitSync may block before it is retried, in nanoseconds.
+    constexpr GLuint64 kWaitTimeout { 1'000'000 };
+}
+
+StreamBuffer::StreamBuffer(size_t regionSize, size_t regions, Mode mode)
+    : mBuffer { GlBuffer::create() }, mRegionSize { regionSize },
+      mPersistent { mode == Mode::Auto && (GLAD_GL_VERSION_4_4 || GLAD_GL_ARB_buffer_storage) } {
+    regions = std::max<size_t>(regions, 1);
+    auto& state { GlState::shared() };
+    state.bindBuffer(kMapTarget, mBuffer.get());
+    if (mPersistent) {
+        GLCHECK(glBufferStorage(kMapTarget, mRegionSize * regions, nullptr, kPersistentFlags));
+        mMapped = static_cast<std::byte*>(GLCHECK(glMapBufferRange(kMapTarget, 0, mRegionSize * regions, kPersistentFlags)));
+        if (mMapped == nullptr) {
+            std::cout << "ERROR::STREAM_BUFFER::PERSISTENT_MAP_FAILED: falling back to orphaning" << std::endl;
+            // storage from glBufferStorage is immutable, so the fallback needs a new buffer.
+            mBuffer = GlBuffer::create();
+            state.bindBuffer(kMapTarget, mBuffer.get());
+            mPersistent = false;
+        }
+    }
+    if (mPersistent) {
+        mFences.resize(regions);
+    } else {
+        GLCHECK(glBufferData(kMapTarget, mRegionSize, nullptr, GL_STREAM_DRAW));
+    }
+}
+
+StreamBuffer::~StreamBuffer() {
+    for (auto fence : mFences) {
+        if (fence != nullptr) {
+            glDeleteSync(static_cast<GLsync>(fence));
+        }
+    }
+    if (mMapped != nullptr || mMapPending) {
+        GlState::shared().bindBuffer(kMapTarget, mBuffer.get());
+        glUnmapBuffer(kMapTarget);
+    }
+}
+
+void* StreamBuffer::map(size_t size, size_t alignment) {
+    if (mMapPending) {
+        commit(0);
+    }
+    alignment = std::max<size_t>(alignment, 1);
+    const size_t offset { (mCursor + alignment - 1) / alignment * alignment };
+    if (offset > mRegionSize || size > mRegionSize - offset) {
+        return nullptr;
+    }
+
+    void* data {};
+    if (mPersistent) {
+        if (!mFrameStarted) {
+            waitForRegion();
+        }
+        data = mMapped + mRegion * mRegionSize + offset;
+    } else {
+        // the first map of a frame orphans the storage the GPU may still be reading; later
+        // ones append behind data already handed to draws, so there is nothing to wait for.
+        const GLbitfield flags { mFrameStarted ? kAppendFlags : kOrphanFlags };
+        GlState::shared().bindBuffer(kMapTarget, mBuffer.get());
+        data = GLCHECK(glMapBufferRange(kMapTarget, offset, size, flags));
+        if (data == nullptr) {
+            std::cout << "ERROR::STREAM_BUFFER::MAP_FAILED: " << size << " bytes at offset " << offset << std::endl;
+            return nullptr;
+        }
+    }
+    mFrameStarted = true;
+    mMapOffset = offset;
+    mMapSize = size;
+    mMapPending = true;
+    return data;
+}
+
+size_t StreamBuffer::commit(size_t size) {
+    const size_t regionBase { mPersistent ? mRegion * mRegionSize : 0 };
+    if (!mMapPending) {
+        std::cout << "ERROR::STREAM_BUFFER::COMMIT_WITHOUT_MAP" << std::endl;
+        return regionBase + mCursor;
+    }
+    // coherent persistent memory is visible to GL as written; the orphaning path has to unmap before drawing.
+    if (!mPersistent) {
+        GlState::shared().bindBuffer(kMapTarget, mBuffer.get());
+        if (glUnmapBuffer(kMapTarget) == GL_FALSE) {
+            std::cout << "ERROR::STREAM_BUFFER::DATA_LOST_WHILE_MAPPED" << std::endl;
+        }
+    }
+    mCursor = mMapOffset + std::min(size, mMapSize);
+    mMapPending = false;
+    return regionBase + mMapOffset;
+}
+
+void StreamBuffer::endFrame() {
+    if (mMapPending) {
+        commit(0);
+    }
+    if (mPersistent) {
+        if (mFrameStarted) {
+            mFences[mRegion] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        }
+        mRegion = (mRegion + 1) % mFences.size();
+    }
+    mCursor = 0;
+    mFrameStarted = false;
+    mStats.frames++;
+}
+
+void StreamBuffer::waitForRegion() {
+    auto& fence { mFences[mRegion] };
+    if (fence == nullptr) {
+        return;
+    }
+    const auto sync { static_cast<GLsync>(fence) };
+    GLenum result { glClientWaitSync(sync, 0, 0) };
+    if (result == GL_TIMEOUT_EXPIRED) {
+        mStats.stalls++;
+        // the flush makes sure the fence itself reaches the GPU, or the wait could never end.
+        do {
+            result = glClientWaitSync(sync, GL_SYNC_FLUSH_COMMANDS_BIT, kWaitTimeout);
+        } while (result == GL_TIMEOUT_EXPIRED);
+    }
+    if (result == GL_WAIT_FAILED) {
+        std::cout << "ERROR::STREAM_BUFFER::FENCE_WAIT_FAILED" << std::endl;
+    }
+    glDeleteSync(sync);
+    fence = nullptr;
+}
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <GlHandle.h>
+
+#include <cstddef>
+#include <vector>
+
+// Buffer for data rewritten every frame, like UI or particle vertices. Producers write
+// straight into mapped GL memory and draw from the returned offsets; nothing is reallocated
+// after construction:
+//
+//     StreamBuffer vertices(1 << 20);
+//     auto* quads { static_cast<Vertex*>(vertices.map(count * sizeof(Vertex))) };
+//     ...write up to count vertices...
+//     const size_t offset { vertices.commit(written * sizeof(Vertex)) };
+//     ...draw from vertices.buffer() starting at offset...
+//     vertices.endFrame();
+//
+// With GL 4.4 or ARB_buffer_storage the buffer holds regions frame regions and stays
+// persistently and coherently mapped. Each frame writes its own region, and endFrame()
+// fences it, so the CPU only waits when it comes back around to a region the GPU is still
+// reading, regions frames later. Otherwise, as on the 3.3 core context main() asks for,
+// the buffer is one region that is orphaned at the start of every frame and mapped per
+// map() call with GL_MAP_UNSYNCHRONIZED_BIT, which is safe because writes in a frame never
+// overlap. Mode::Orphaning picks that path even where persistent mapping is available.
+class StreamBuffer {
+public:
+    enum class Mode {
+        // persistent when the context allows it, orphaning otherwise.
+        Auto,
+        // always orphan. for users that restart at offset 0 many times a frame (see InstancedQuads),
+        // where fenced regions would make every restart wait for the GPU.
+        Orphaning,
+    };
+
+    struct Stats {
+        // endFrame() calls so far.
+        size_t frames {};
+        // map() calls that had to wait for the GPU to release their region.
+        size_t stalls {};
+    };
+
+    // regionSize is the most a single frame can write.
+    // ------------------------------------------------------------------------
+    explicit StreamBuffer(size_t regionSize, size_t regions = 3, Mode mode = Mode::Auto);
+    StreamBuffer(const StreamBuffer&) = delete;
+    StreamBuffer& operator=(const StreamBuffer&) = delete;
+    ~StreamBuffer();
+
+    // writable memory for up to size bytes at the next multiple of alignment in this frame's
+    // region, or nullptr if they do not fit. valid until the matching commit().
+    // ------------------------------------------------------------------------
+    void* map(size_t size, size_t alignment = 4);
+    // keep the first size bytes written since map() and make them visible to GL. returns
+    // their byte offset into buffer().
+    // ------------------------------------------------------------------------
+    size_t commit(size_t size);
+    // fence the region written this frame and move on to the next one.
+    // ------------------------------------------------------------------------
+    void endFrame();
+
+    unsigned int buffer() const { return mBuffer.get(); }
+    // bytes left in this frame's region.
+    size_t remaining() const { return mRegionSize - mCursor; }
+    size_t regionSize() const { return mRegionSize; }
+    bool persistent() const { return mPersistent; }
+    const Stats& stats() const { return mStats; }
+
+private:
+    GlBuffer mBuffer;
+    size_t mRegionSize {};
+    bool mPersistent {};
+    // start of the persistent mapping, nullptr on the orphaning path.
+    std::byte* mMapped {};
+    // one fence per region, null until the region was used once. GLsync is a pointer type.
+    std::vector<void*> mFences;
+    size_t mRegion {};
+    size_t mCursor {};
+    // region relative offset and size of the range handed out by the last map(), while mMapPending.
+    size_t mMapOffset {};
+    size_t mMapSize {};
+    bool mMapPending {};
+    // the orphaning path throws the old storage away on the first map of a frame.
+    bool mFrameStarted {};
+    Stats mStats {};
+
+    // ------------------------------------------------------------------------
+    void waitForRegion();
+};
@@ -0,0 +1,9 @@
+#include "Transform2D.h"
+
+#include <glm/ext/matrix_transform.hpp>
+
+glm::mat4 Transform2D::model() const {
+    glm::mat4 model { glm::translate(glm::mat4(1.0f), glm::vec3(mPosition + mCenter, 0.0f)) };
+    model = glm::rotate(model, mAngle, glm::vec3(0.0f, 0.0f, 1.0f));
+    return glm::translate(model, glm::vec3(-mCenter, 0.0f));
+}
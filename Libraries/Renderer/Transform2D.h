@@ -0,0 +1,42 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <array>
+#include <cstddef>
+
+// Position and rotation of a mesh whose vertices stay as uploaded, as the model matrix a
+// shader applies to them. The mesh rotates about its centroid, which is computed once from
+// the untransformed vertices of any vertex struct with a pos member:
+//
+//     Transform2D transform { vertices };
+//     transform.rotate(deltaRad);
+//     shader.set<ModelUniform>(transform.model());
+//
+// set* replace the angle or offset, rotate/translate add to them.
+class Transform2D {
+public:
+    template <typename Vertex, size_t N>
+    explicit Transform2D(const std::array<Vertex, N>& verticies) {
+        for (const auto& vertex : verticies) {
+            mCenter += glm::vec2(vertex.pos);
+        }
+        mCenter /= static_cast<float>(N);
+    }
+
+    // angleRad turns the mesh about its centroid, the position offsets it from where its vertices were uploaded.
+    // ------------------------------------------------------------------------
+    void setRotation(float angleRad) { mAngle = angleRad; }
+    void setPosition(float x, float y) { mPosition = glm::vec2(x, y); }
+    // ------------------------------------------------------------------------
+    void rotate(float angleRad) { mAngle += angleRad; }
+    void translate(float moveX, float moveY) { mPosition += glm::vec2(moveX, moveY); }
+
+    // ------------------------------------------------------------------------
+    glm::mat4 model() const;
+
+private:
+    glm::vec2 mCenter {};
+    glm::vec2 mPosition {};
+    float mAngle {};
+};
@@ -0,0 +1,98 @@
+#include "VertexArrayCache.h"
+
+#include <algorithm>
+#include <iostream>
+
+#include <GlDebug.h>
+#include <GlState.h>
+#include <glad/glad.h>
+
+namespace {
+    // float components of an attribute type, or 0 for types this layout cannot feed.
+    int attributeComponents(GLenum type) {
+        switch (type) {
+        case GL_FLOAT:
+            return 1;
+        case GL_FLOAT_VEC2:
+            return 2;
+        case GL_FLOAT_VEC3:
+            return 3;
+        case GL_FLOAT_VEC4:
+            return 4;
+        default:
+            return 0;
+        }
+    }
+}
+
+VertexArrayCache::VertexArrayCache(VertexLayout layout, unsigned int vertexBuffer, unsigned int elementBuffer) : mElementBuffer { elementBuffer } {
+    mSources.push_back({ std::move(layout), vertexBuffer });
+}
+
+VertexArrayCache::VertexArrayCache(VertexLayout layout, unsigned int vertexBuffer, unsigned int elementBuffer, VertexLayout instanceLayout,
+                                   unsigned int instanceBuffer)
+    : VertexArrayCache(std::move(layout), vertexBuffer, elementBuffer) {
+    mSources.push_back({ std::move(instanceLayout), instanceBuffer });
+}
+
+void VertexArrayCache::bind(Shader& shader) {
+    const auto it { std::find_if(mEntries.begin(), mEntries.end(),
+        [&](const Entry& entry) { return entry.shader == shader.serial(); }) };
+    if (it == mEntries.end()) {
+        auto vao { build(shader) };
+        mEntries.push_back({ shader.serial(), shader.generation(), std::move(vao) });
+    } else if (it->generation != shader.generation()) {
+        // the attribute locations may have moved with the reload; the old VAO is deleted here.
+        it->vao = build(shader);
+        it->generation = shader.generation();
+    } else {
+        GlState::shared().bindVertexArray(it->vao.get());
+    }
+}
+
+GlVertexArray VertexArrayCache::build(Shader& shader) {
+    // reflect first; a deferred build would otherwise report no attributes.
+    const auto& attributes { shader.attributes() };
+
+    auto vao { GlVertexArray::create() };
+    auto& state { GlState::shared() };
+    state.bindVertexArray(vao.get());
+    if (mElementBuffer != 0) {
+        state.bindBuffer(GL_ELEMENT_ARRAY_BUFFER, mElementBuffer);
+    }
+
+    for (const auto& attribute : attributes) {
+        const Source* layoutSource {};
+        const VertexAttribute* source {};
+        for (const auto& candidate : mSources) {
+            const auto it { std::find_if(candidate.layout.attributes.begin(), candidate.layout.attributes.end(),
+                [&](const VertexAttribute& vertexAttribute) { return vertexAttribute.name == attribute.name; }) };
+            if (it != candidate.layout.attributes.end()) {
+                layoutSource = &candidate;
+                source = &*it;
+                break;
+            }
+        }
+        if (source == nullptr) {
+            std::cout << "ERROR::VERTEX_ARRAY::ATTRIBUTE_NOT_IN_LAYOUT: " << attribute.name << std::endl;
+            continue;
+        }
+        if (attributeComponents(attribute.type) != source->components) {
+            // GL pads or drops components silently, which hides mistakes like a vec2 fed three floats.
+            std::cout << "ERROR::VERTEX_ARRAY::COMPONENT_MISMATCH: " << attribute.name << " reads " << attributeComponents(attribute.type)
+                      << " components, the layout provides " << source->components << std::endl;
+        }
+        const auto location { static_cast<GLuint>(attribute.location) };
+        // glVertexAttribPointer captures whatever is bound to GL_ARRAY_BUFFER.
+        state.bindBuffer(GL_ARRAY_BUFFER, layoutSource->buffer);
+        GLCHECK(glVertexAttribPointer(location, source->components, GL_FLOAT, GL_FALSE, static_cast<GLsizei>(layoutSource->layout.stride),
+                                      reinterpret_cast<const void*>(source->offset)));
+        if (layoutSource->layout.divisor != 0) {
+            GLCHECK(glVertexAttribDivisor(location, layoutSource->layout.divisor));
+        }
+        GLCHECK(glEnableVertexAttribArray(location));
+    }
+
+    // left bound, as bind() promises.
+    return vao;
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include "VertexLayout.h"
+
+#include <GlHandle.h>
+#include <Shader.h>
+
+#include <cstdint>
+#include <vector>
+
+// Vertex array objects for one set of buffers, built from what each program actually reads.
+// The first draw with a program matches its active attributes (Shader::attributes) against
+// the layout by name and records a VAO with exactly those attributes enabled; later draws
+// with that program only bind it. Attributes the program does not read are never set up.
+// An optional second layout and buffer feed per instance attributes; names are looked up in
+// the vertex layout first.
+class VertexArrayCache {
+public:
+    // elementBuffer may be 0 for meshes drawn without indices.
+    VertexArrayCache(VertexLayout layout, unsigned int vertexBuffer, unsigned int elementBuffer = 0);
+    VertexArrayCache(VertexLayout layout, unsigned int vertexBuffer, unsigned int elementBuffer, VertexLayout instanceLayout,
+                     unsigned int instanceBuffer);
+
+    // bind the VAO for this program, building it on first use.
+    // ------------------------------------------------------------------------
+    void bind(Shader& shader);
+
+private:
+    // keyed by Shader::serial(), not the program name: a hot reload deletes the old program
+    // and GL may give its name to an unrelated one. a newer generation rebuilds the VAO in place.
+    struct Entry {
+        std::uint64_t shader {};
+        unsigned int generation {};
+        GlVertexArray vao;
+    };
+
+    struct Source {
+        VertexLayout layout;
+        unsigned int buffer {};
+    };
+
+    // the vertex buffer, then the instance buffer if there is one.
+    std::vector<Source> mSources;
+    unsigned int mElementBuffer {};
+    // a handful of programs per mesh at most, so a flat list beats a map.
+    std::vector<Entry> mEntries;
+
+    GlVertexArray build(Shader& shader);
+};
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <cstddef>
+#include <initializer_list>
+#include <string_view>
+#include <vector>
+
+// One member of a C++ vertex struct, matched to a shader attribute by name.
+struct VertexAttribute {
+    std::string_view name;
+    int components {};
+    size_t offset {};
+};
+
+namespace detail {
+    template <typename T> constexpr int kVertexComponents { 0 };
+    template <> constexpr int kVertexComponents<float> { 1 };
+    template <> constexpr int kVertexComponents<glm::vec2> { 2 };
+    template <> constexpr int kVertexComponents<glm::vec3> { 3 };
+    template <> constexpr int kVertexComponents<glm::vec4> { 4 };
+}
+
+// The float attributes of a vertex struct and its stride, e.g.
+//
+//     const VertexLayout layout { VertexLayout::of<Vertex>({
+//         VertexLayout::attribute("aPos", &Vertex::pos),
+//         VertexLayout::attribute("aColor", &Vertex::color) }) };
+//
+// Component counts and offsets come from the member types, so there are no magic numbers to get wrong.
+// A divisor of 1 makes the attributes advance once per instance instead of once per vertex.
+struct VertexLayout {
+    std::vector<VertexAttribute> attributes;
+    size_t stride {};
+    unsigned int divisor {};
+
+    template <typename Vertex, typename Member>
+    static VertexAttribute attribute(std::string_view name, Member Vertex::* member) {
+        static_assert(detail::kVertexComponents<Member> != 0, "vertex members have to be float or glm::vec2/3/4");
+        const Vertex vertex {};
+        const auto offset { reinterpret_cast<const std::byte*>(&(vertex.*member)) - reinterpret_cast<const std::byte*>(&vertex) };
+        return { name, detail::kVertexComponents<Member>, static_cast<size_t>(offset) };
+    }
+
+    template <typename Vertex>
+    static VertexLayout of(std::initializer_list<VertexAttribute> attributes, unsigned int divisor = 0) {
+        return { attributes, sizeof(Vertex), divisor };
+    }
+};
@@ -0,0 +1,109 @@
+#include "ProgramPipeline.h"
+#include "Shader.h"
+
+#include <algorithm>
+#include <iostream>
+
+#include <GlDebug.h>
+#include <GlState.h>
+#include <glad/glad.h>
+#include <glm/gtc/type_ptr.hpp>
+
+SeparableProgram::SeparableProgram(Stage stage, std::string_view source) : mStage { stage } {
+    // glCreateShaderProgramv only takes terminated strings.
+    const std::string code { source };
+    const char* codePointer { code.c_str() };
+    mProgram.reset(GLCHECK(glCreateShaderProgramv(stage == Stage::Vertex ? GL_VERTEX_SHADER : GL_FRAGMENT_SHADER, 1, &codePointer)));
+
+    int success {};
+    GLCHECK(glGetProgramiv(mProgram.get(), GL_LINK_STATUS, &success));
+    mLinked = success;
+    if (!mLinked) {
+        // the program log of glCreateShaderProgramv also carries the compile log.
+        char infoLog[1024];
+        GLCHECK(glGetProgramInfoLog(mProgram.get(), 1024, NULL, infoLog));
+        std::cout << "ERROR::SEPARABLE_PROGRAM_LINKING_ERROR of type: " << (stage == Stage::Vertex ? "VERTEX" : "FRAGMENT") << "\n"
+                  << infoLog << "\n -- --------------------------------------------------- -- " << std::endl;
+        return;
+    }
+
+    int count {};
+    int maxNameLength {};
+    GLCHECK(glGetProgramiv(mProgram.get(), GL_ACTIVE_UNIFORMS, &count));
+    GLCHECK(glGetProgramiv(mProgram.get(), GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxNameLength));
+    std::string name(static_cast<size_t>(std::max(maxNameLength, 1)), '\0');
+    for (int i = 0; i < count; i++) {
+        int length {};
+        int size {};
+        GLenum type {};
+        GLCHECK(glGetActiveUniform(mProgram.get(), static_cast<GLuint>(i), maxNameLength, &length, &size, &type, name.data()));
+        std::string uniformName(name.data(), static_cast<size_t>(length));
+        const int location { GLCHECK(glGetUniformLocation(mProgram.get(), uniformName.c_str())) };
+        if (location < 0) {
+            continue;
+        }
+        if (uniformName.ends_with("[0]")) {
+            mUniforms.emplace_back(uniformName.substr(0, uniformName.size() - 3), location);
+        }
+        mUniforms.emplace_back(std::move(uniformName), location);
+    }
+    std::sort(mUniforms.begin(), mUniforms.end());
+}
+
+std::shared_ptr<SeparableProgram> SeparableProgram::fromFile(Stage stage, const std::filesystem::path& path,
+                                                             std::span<const ShaderPreprocessor::Define> defines) {
+    const auto source { ShaderPreprocessor::shared().process(path, defines) };
+    return std::make_shared<SeparableProgram>(stage, source.source);
+}
+
+int SeparableProgram::uniformLocation(std::string_view name) const {
+    const auto it { std::lower_bound(mUniforms.begin(), mUniforms.end(), name,
+        [](const std::pair<std::string, int>& uniform, std::string_view key) { return std::string_view(uniform.first) < key; }) };
+    if (it == mUniforms.end() || it->first != name) {
+        return -1;
+    }
+    return it->second;
+}
+
+void SeparableProgram::setInt(std::string_view name, int value) {
+    GLCHECK(glProgramUniform1i(mProgram.get(), uniformLocation(name), value));
+}
+
+void SeparableProgram::setFloat(std::string_view name, float value) {
+    GLCHECK(glProgramUniform1f(mProgram.get(), uniformLocation(name), value));
+}
+
+void SeparableProgram::setVec2(std::string_view name, const glm::vec2& value) {
+    GLCHECK(glProgramUniform2fv(mProgram.get(), uniformLocation(name), 1, glm::value_ptr(value)));
+}
+
+void SeparableProgram::setVec3(std::string_view name, const glm::vec3& value) {
+    GLCHECK(glProgramUniform3fv(mProgram.get(), uniformLocation(name), 1, glm::value_ptr(value)));
+}
+
+void SeparableProgram::setVec4(std::string_view name, const glm::vec4& value) {
+    GLCHECK(glProgramUniform4fv(mProgram.get(), uniformLocation(name), 1, glm::value_ptr(value)));
+}
+
+void SeparableProgram::setMat4(std::string_view name, const glm::mat4& value) {
+    GLCHECK(glProgramUniformMatrix4fv(mProgram.get(), uniformLocation(name), 1, GL_FALSE, glm::value_ptr(value)));
+}
+
+bool ProgramPipelineCache::supported() {
+    return GLAD_GL_VERSION_4_1 || GLAD_GL_ARB_separate_shader_objects;
+}
+
+void ProgramPipelineCache::bind(const std::shared_ptr<SeparableProgram>& vertex, const std::shared_ptr<SeparableProgram>& fragment) {
+    const std::uint64_t key { (static_cast<std::uint64_t>(vertex->id()) << 32) | fragment->id() };
+    auto& pipeline { mPipelines[key] };
+    if (!pipeline.pipeline) {
+        pipeline.pipeline = GlProgramPipeline::create();
+        GLCHECK(glUseProgramStages(pipeline.pipeline.get(), GL_VERTEX_SHADER_BIT, vertex->id()));
+        GLCHECK(glUseProgramStages(pipeline.pipeline.get(), GL_FRAGMENT_SHADER_BIT, fragment->id()));
+        pipeline.vertex = vertex;
+        pipeline.fragment = fragment;
+    }
+
+    Shader::unbind();
+    GlState::shared().bindProgramPipeline(pipeline.pipeline.get());
+}
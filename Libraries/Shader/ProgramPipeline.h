@@ -0,0 +1,85 @@
+#pragma once
+
+#include "ShaderPreprocessor.h"
+
+#include <GlHandle.h>
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// One shader stage linked on its own as a separable program (glCreateShaderProgramv, GL 4.1).
+// Any vertex program can be combined with any fragment program through a ProgramPipeline
+// without linking the pair, so N vertex and M fragment shaders cost N + M compiles.
+// Stage interfaces are matched by name, or by location where both sides declare one; the
+// outputs of basic.vert and texture.vert have no layout(location), so they pair by name.
+class SeparableProgram {
+public:
+    enum class Stage {
+        Vertex,
+        Fragment,
+    };
+
+    SeparableProgram(Stage stage, std::string_view source);
+
+    // preprocess a file (includes, defines) and build it as a separable program.
+    // ------------------------------------------------------------------------
+    static std::shared_ptr<SeparableProgram> fromFile(Stage stage, const std::filesystem::path& path,
+                                                      std::span<const ShaderPreprocessor::Define> defines = {});
+
+    unsigned int id() const { return mProgram.get(); }
+    Stage stage() const { return mStage; }
+    bool linked() const { return mLinked; }
+
+    // uniforms are written with glProgramUniform*, so the program does not need to be bound.
+    // ------------------------------------------------------------------------
+    int uniformLocation(std::string_view name) const;
+    void setInt(std::string_view name, int value);
+    void setFloat(std::string_view name, float value);
+    void setVec2(std::string_view name, const glm::vec2& value);
+    void setVec3(std::string_view name, const glm::vec3& value);
+    void setVec4(std::string_view name, const glm::vec4& value);
+    void setMat4(std::string_view name, const glm::mat4& value);
+
+private:
+    GlProgram mProgram;
+    Stage mStage {};
+    bool mLinked {};
+    // active uniform locations sorted by name.
+    std::vector<std::pair<std::string, int>> mUniforms;
+};
+
+// Program pipeline objects for vertex/fragment pairs of separable programs, created the
+// first time a pair is bound and reused afterwards.
+class ProgramPipelineCache {
+public:
+    ProgramPipelineCache() = default;
+
+    // separable programs need GL 4.1 or ARB_separate_shader_objects.
+    // ------------------------------------------------------------------------
+    static bool supported();
+
+    // bind the pipeline for this pair, creating it on first use. a bound Shader program
+    // would take precedence over any pipeline, so it is unbound first.
+    // ------------------------------------------------------------------------
+    void bind(const std::shared_ptr<SeparableProgram>& vertex, const std::shared_ptr<SeparableProgram>& fragment);
+
+    size_t size() const { return mPipelines.size(); }
+
+private:
+    struct Pipeline {
+        GlProgramPipeline pipeline;
+        // held so a program name is never reused while a pipeline still refers to it.
+        std::shared_ptr<SeparableProgram> vertex;
+        std::shared_ptr<SeparableProgram> fragment;
+    };
+
+    std::unordered_map<std::uint64_t, Pipeline> mPipelines;
+};
@@ -1,97 +1,763 @@
 #include "Shader.h"
+#include "ShaderHash.h"
+#include "ShaderPreprocessor.h"
+#include "ShaderProfiler.h"
+#include "ShaderWatcher.h"
 
 #include <fstream>  
-#include <sstream>
 #include <string>
 #include <iostream>
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <iterator>
 
+#include <GlDebug.h>
+#include <GlState.h>
 #include <glad/glad.h>
+#include <glm/gtc/type_ptr.hpp>
 
-Shader::Shader(const char* vertexPath, const char* fragmentPath) {
-    // 1. retrieve the vertex/fragment source code from filePath
-    std::string vertexCode;
-    std::string fragmentCode;
-    std::ifstream vShaderFile;
-    std::ifstream fShaderFile;
-    // ensure ifstream objects can throw exceptions:
-    vShaderFile.exceptions(std::ifstream::failbit | std::ifstream::badbit);
-    fShaderFile.exceptions(std::ifstream::failbit | std::ifstream::badbit);
-    try {
-        // open files
-        vShaderFile.open(vertexPath);
-        fShaderFile.open(fragmentPath);
-        std::stringstream vShaderStream, fShaderStream;
-        // read file's buffer contents into streams
-        vShaderStream << vShaderFile.rdbuf();
-        fShaderStream << fShaderFile.rdbuf();
-        // close file handlers
-        vShaderFile.close();
-        fShaderFile.close();
-        // convert stream into string
-        vertexCode = vShaderStream.str();
-        fragmentCode = fShaderStream.str();
-    } catch (std::ifstream::failure& e) {
-        std::cout << "ERROR::SHADER::FILE_NOT_SUCCESSFULLY_READ: " << e.what() << std::endl;
-    }
-    const char* vShaderCode = vertexCode.c_str();
-    const char* fShaderCode = fragmentCode.c_str();
-    // 2. compile shaders
-    unsigned int vertex, fragment;
-    // vertex shader
-    vertex = glCreateShader(GL_VERTEX_SHADER);
-    glShaderSource(vertex, 1, &vShaderCode, NULL);
-    glCompileShader(vertex);
-    checkCompileErrors(vertex, "VERTEX");
-    // fragment Shader
-    fragment = glCreateShader(GL_FRAGMENT_SHADER);
-    glShaderSource(fragment, 1, &fShaderCode, NULL);
-    glCompileShader(fragment);
-    checkCompileErrors(fragment, "FRAGMENT");
-    // shader Program
-    ID = glCreateProgram();
-    glAttachShader(ID, vertex);
-    glAttachShader(ID, fragment);
-    glLinkProgram(ID);
-    checkCompileErrors(ID, "PROGRAM");
-    // delete the shaders as they're linked into our program now and no longer necessary
-    glDeleteShader(vertex);
-    glDeleteShader(fragment);
+// the KHR and ARB parallel_shader_compile extensions share this enum.
+#ifndef GL_COMPLETION_STATUS_KHR
+#define GL_COMPLETION_STATUS_KHR 0x91B1
+#endif
+
+namespace {
+    constexpr std::uint32_t kBinaryCacheMagic { 0x4250474C }; // "LGPB"
+
+    bool hasExtension(std::string_view name) {
+        int count {};
+        glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+        for (int i = 0; i < count; i++) {
+            const auto extension { reinterpret_cast<const char*>(glGetStringi(GL_EXTENSIONS, static_cast<GLuint>(i))) };
+            if (extension != nullptr && name == extension) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool parallelCompileSupported() {
+        static const bool supported { hasExtension("GL_KHR_parallel_shader_compile") || hasExtension("GL_ARB_parallel_shader_compile") };
+        return supported;
+    }
+
+    // sampler uniforms hold a texture unit and are set with glUniform1i.
+    bool isSampler(GLenum type) {
+        switch (type) {
+        case GL_SAMPLER_1D: case GL_SAMPLER_2D: case GL_SAMPLER_3D: case GL_SAMPLER_CUBE:
+        case GL_SAMPLER_2D_ARRAY: case GL_SAMPLER_2D_SHADOW: case GL_SAMPLER_BUFFER:
+        case GL_INT_SAMPLER_2D: case GL_UNSIGNED_INT_SAMPLER_2D:
+            return true;
+        default:
+            return false;
+        }
+    }
+
+    // 32 bit components of a uniform type, or 0 for types that are not shadowed.
+    size_t shadowComponents(GLenum type) {
+        switch (type) {
+        case GL_FLOAT: case GL_INT: case GL_UNSIGNED_INT: case GL_BOOL:
+            return 1;
+        case GL_FLOAT_VEC2: case GL_INT_VEC2: case GL_BOOL_VEC2:
+            return 2;
+        case GL_FLOAT_VEC3: case GL_INT_VEC3: case GL_BOOL_VEC3:
+            return 3;
+        case GL_FLOAT_VEC4: case GL_INT_VEC4: case GL_BOOL_VEC4: case GL_FLOAT_MAT2:
+            return 4;
+        case GL_FLOAT_MAT3:
+            return 9;
+        case GL_FLOAT_MAT4:
+            return 16;
+        default:
+            return isSampler(type) ? 1 : 0;
+        }
+    }
+
+    // read the current value of a shadowed uniform into its shadow slot, in the bit pattern the
+    // matching setter would write: floats for float vectors and matrices, ints for everything else.
+    void readUniform(GLuint program, GLint location, GLenum type, std::uint32_t* shadow) {
+        switch (type) {
+        case GL_FLOAT: case GL_FLOAT_VEC2: case GL_FLOAT_VEC3: case GL_FLOAT_VEC4:
+        case GL_FLOAT_MAT2: case GL_FLOAT_MAT3: case GL_FLOAT_MAT4:
+            GLCHECK(glGetUniformfv(program, location, reinterpret_cast<GLfloat*>(shadow)));
+            break;
+        case GL_UNSIGNED_INT:
+            GLCHECK(glGetUniformuiv(program, location, reinterpret_cast<GLuint*>(shadow)));
+            break;
+        default:
+            GLCHECK(glGetUniformiv(program, location, reinterpret_cast<GLint*>(shadow)));
+            break;
+        }
+    }
+
+    // glProgramUniform* writes into a program without binding it.
+    bool programUniformSupported() {
+        return GLAD_GL_VERSION_4_1 || GLAD_GL_ARB_separate_shader_objects;
+    }
+
+    bool programBinarySupported() {
+        // core since 4.1, and offered as ARB_get_program_binary by 3.3 contexts like the one main() asks for.
+        // some drivers also report zero formats when they cannot reload binaries.
+        static const bool supported { [] {
+            if (!GLAD_GL_VERSION_4_1 && !GLAD_GL_ARB_get_program_binary) {
+                return false;
+            }
+            int formats {};
+            GLCHECK(glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats));
+            return formats > 0;
+        }() };
+        return supported;
+    }
+}
+
+std::filesystem::path Shader::sBinaryCacheDirectory {};
+
+Shader::Shader(const char* vertexPath, const char* fragmentPath, CompileMode mode) : Shader(vertexPath, fragmentPath, {}, mode) {}
+
+Shader::Shader(const char* vertexPath, const char* fragmentPath, std::span<const ShaderPreprocessor::Define> defines, CompileMode mode)
+    : mVertexPath { vertexPath }, mFragmentPath { fragmentPath }, mDefines { defines.begin(), defines.end() } {
+    // 1. retrieve the vertex/fragment source code from filePath, expanding #includes
+    ShaderPreprocessor::Result vertex;
+    ShaderPreprocessor::Result fragment;
+    {
+        ShaderProfiler::ScopedTimer timer { mBuildTimings.readMs };
+        vertex = ShaderPreprocessor::shared().process(mVertexPath, mDefines);
+        fragment = ShaderPreprocessor::shared().process(mFragmentPath, mDefines);
+    }
+    buildFiles(vertex, fragment, mode, compileStage);
+}
+
+Shader::Shader(const char* vertexPath, const char* fragmentPath, std::span<const ShaderPreprocessor::Define> defines,
+               const ShaderPreprocessor::Result& vertex, const ShaderPreprocessor::Result& fragment, double readMs, CompileMode mode,
+               const StageCompiler& compileStage)
+    : mVertexPath { vertexPath }, mFragmentPath { fragmentPath }, mDefines { defines.begin(), defines.end() } {
+    mBuildTimings.readMs = readMs;
+    buildFiles(vertex, fragment, mode, compileStage);
+}
+
+void Shader::buildFiles(const ShaderPreprocessor::Result& vertex, const ShaderPreprocessor::Result& fragment, CompileMode mode,
+                        const StageCompiler& compileStage) {
+    mBuildTimings.name = mVertexPath.generic_string() + " + " + mFragmentPath.generic_string();
+    mBuildTimings.deferred = mode == CompileMode::Deferred;
+    mVertexFiles = vertex.files;
+    mFragmentFiles = fragment.files;
+    mBuildTimings.files = vertex.reads;
+    mBuildTimings.files.insert(mBuildTimings.files.end(), fragment.reads.begin(), fragment.reads.end());
+    // 2. submit the build, and wait for it right away unless the caller polls isReady()
+    build(vertex.source, fragment.source, compileStage);
+    if (mode == CompileMode::Blocking) {
+        finishBuild();
+    }
+}
+
+Shader::Shader(const ShaderSource& source, CompileMode mode) : Shader(source, mode, compileStage) {}
+
+Shader::Shader(const ShaderSource& source, CompileMode mode, const StageCompiler& compileStage) {
+    // in-memory sources have no file names, so the report names them by content.
+    char name[32] {};
+    std::snprintf(name, sizeof(name), "<source %016llx>",
+                  static_cast<unsigned long long>(shaderHash(source.fragment, shaderHash(source.vertex))));
+    mBuildTimings.name = name;
+    mBuildTimings.deferred = mode == CompileMode::Deferred;
+    build(source.vertex, source.fragment, compileStage);
+    if (mode == CompileMode::Blocking) {
+        finishBuild();
+    }
+}
+
+void Shader::setBinaryCacheDirectory(const std::filesystem::path& directory) {
+    sBinaryCacheDirectory = directory;
+}
+
+void Shader::setMaxCompilerThreads(unsigned int count) {
+#ifdef GL_KHR_parallel_shader_compile
+    if (parallelCompileSupported() && glMaxShaderCompilerThreadsKHR != nullptr) {
+        glMaxShaderCompilerThreadsKHR(count);
+    }
+#endif
+}
+
+bool Shader::isReady() {
+    if (!mBuild.program) {
+        return true;
+    }
+    if (!compileFinished(mBuild.program.get())) {
+        return false;
+    }
+    finishBuild();
+    return true;
+}
+
+void Shader::enableHotReload() {
+    if (!mWatcher && !mVertexPath.empty()) {
+        // watch the included files too, and preprocess on the watcher thread so includes stay off the render thread
+        std::vector<std::filesystem::path> files { mVertexFiles };
+        files.insert(files.end(), mFragmentFiles.begin(), mFragmentFiles.end());
+        mWatcher = std::make_unique<ShaderWatcher>(std::move(files), [vertexPath = mVertexPath, fragmentPath = mFragmentPath, defines = mDefines] {
+            auto vertex { ShaderPreprocessor::shared().process(vertexPath, defines) };
+            auto fragment { ShaderPreprocessor::shared().process(fragmentPath, defines) };
+            if (!vertex.success || !fragment.success) {
+                return std::vector<std::string> {};
+            }
+            return std::vector { std::move(vertex.source), std::move(fragment.source) };
+        });
+    }
+}
+
+bool Shader::reloadIfChanged() {
+    if (mPending.program) {
+        // submitted on an earlier call, so the driver has had at least a frame to finish it.
+        if (!compileFinished(mPending.program.get())) {
+            return false;
+        }
+        int success {};
+        {
+            ShaderProfiler::ScopedTimer timer { mPendingTimings.statusMs };
+            GLCHECK(glGetProgramiv(mPending.program.get(), GL_LINK_STATUS, &success));
+        }
+        ShaderProfiler::shared().record(mPendingTimings);
+        if (success) {
+            finishBuild();
+            mProgram = std::move(mPending.program);
+            mGeneration++;
+            GLCHECK(glDetachShader(mProgram.get(), mPending.vertex->id()));
+            GLCHECK(glDetachShader(mProgram.get(), mPending.fragment->id()));
+            mVertexStage = mPending.vertex;
+            mFragmentStage = mPending.fragment;
+            reflectUniforms();
+            reflectAttributes();
+            for (const auto& block : mBlockBindings) {
+                applyBlockBinding(block);
+            }
+        } else {
+            checkCompileErrors(mPending.vertex->id(), "VERTEX", mVertexFiles);
+            checkCompileErrors(mPending.fragment->id(), "FRAGMENT", mFragmentFiles);
+            checkCompileErrors(mPending.program.get(), "PROGRAM");
+        }
+        mPending = {};
+        return success;
+    }
+
+    if (!mWatcher) {
+        return false;
+    }
+    auto sources { mWatcher->takeChangedSources() };
+    if (!sources) {
+        return false;
+    }
+    const auto& vertexCode { (*sources)[0] };
+    const auto& fragmentCode { (*sources)[1] };
+    mPendingTimings = { .name = mBuildTimings.name, .deferred = true, .reload = true,
+                        .sourceBytes = vertexCode.size() + fragmentCode.size(), .files = {} };
+    {
+        ShaderProfiler::ScopedTimer timer { mPendingTimings.vertexCompileMs };
+        mPending.vertex = compileStage(GL_VERTEX_SHADER, vertexCode);
+    }
+    {
+        ShaderProfiler::ScopedTimer timer { mPendingTimings.fragmentCompileMs };
+        mPending.fragment = compileStage(GL_FRAGMENT_SHADER, fragmentCode);
+    }
+    ShaderProfiler::ScopedTimer timer { mPendingTimings.linkMs };
+    mPending.program = GlProgram(GLCHECK(glCreateProgram()));
+    GLCHECK(glAttachShader(mPending.program.get(), mPending.vertex->id()));
+    GLCHECK(glAttachShader(mPending.program.get(), mPending.fragment->id()));
+    GLCHECK(glLinkProgram(mPending.program.get()));
+    return false;
 }
 
 void Shader::use() {
-    glUseProgram(ID);
+    finishBuild();
+    GlState::shared().useProgram(mProgram.get());
+}
+
+unsigned int Shader::id() {
+    finishBuild();
+    return mProgram.get();
+}
+
+void Shader::unbind() {
+    GlState::shared().useProgram(0);
+}
+
+int Shader::uniformLocation(std::string_view name) {
+    // the table is only filled once the build is checked; before that every name would miss.
+    finishBuild();
+    const auto it { std::lower_bound(mUniforms.begin(), mUniforms.end(), name,
+        [](const UniformInfo& uniform, std::string_view key) { return std::string_view(uniform.name) < key; }) };
+    if (it == mUniforms.end() || it->name != name) {
+        return -1;
+    }
+    return it->location;
+}
+
+void Shader::setBool(std::string_view name, bool value) {
+    setBool(uniformLocation(name), value);
+}
+
+void Shader::setBool(int location, bool value) {
+    setInt(location, (int)value);
+}
+
+void Shader::setInt(std::string_view name, int value) {
+    setInt(uniformLocation(name), value);
+}
+
+void Shader::setInt(int location, int value) {
+    if (updateShadow(location, &value, sizeof(value))) {
+        if (programUniformSupported()) {
+            GLCHECK(glProgramUniform1i(mProgram.get(), location, value));
+        } else {
+            use();
+            GLCHECK(glUniform1i(location, value));
+        }
+    }
+}
+
+void Shader::setFloat(std::string_view name, float value) {
+    setFloat(uniformLocation(name), value);
+}
+
+void Shader::setFloat(int location, float value) {
+    if (updateShadow(location, &value, sizeof(value))) {
+        if (programUniformSupported()) {
+            GLCHECK(glProgramUniform1f(mProgram.get(), location, value));
+        } else {
+            use();
+            GLCHECK(glUniform1f(location, value));
+        }
+    }
+}
+
+void Shader::setVec2(std::string_view name, const glm::vec2& value) {
+    setVec2(uniformLocation(name), value);
+}
+
+void Shader::setVec2(int location, const glm::vec2& value) {
+    if (updateShadow(location, glm::value_ptr(value), sizeof(value))) {
+        if (programUniformSupported()) {
+            GLCHECK(glProgramUniform2fv(mProgram.get(), location, 1, glm::value_ptr(value)));
+        } else {
+            use();
+            GLCHECK(glUniform2fv(location, 1, glm::value_ptr(value)));
+        }
+    }
+}
+
+void Shader::setVec3(std::string_view name, const glm::vec3& value) {
+    setVec3(uniformLocation(name), value);
+}
+
+void Shader::setVec3(int location, const glm::vec3& value) {
+    if (updateShadow(location, glm::value_ptr(value), sizeof(value))) {
+        if (programUniformSupported()) {
+            GLCHECK(glProgramUniform3fv(mProgram.get(), location, 1, glm::value_ptr(value)));
+        } else {
+            use();
+            GLCHECK(glUniform3fv(location, 1, glm::value_ptr(value)));
+        }
+    }
+}
+
+void Shader::setVec4(std::string_view name, const glm::vec4& value) {
+    setVec4(uniformLocation(name), value);
 }
 
-void Shader::setBool(const std::string& name, bool value) const {
-    glUniform1i(glGetUniformLocation(ID, name.c_str()), (int)value);
+void Shader::setVec4(int location, const glm::vec4& value) {
+    if (updateShadow(location, glm::value_ptr(value), sizeof(value))) {
+        if (programUniformSupported()) {
+            GLCHECK(glProgramUniform4fv(mProgram.get(), location, 1, glm::value_ptr(value)));
+        } else {
+            use();
+            GLCHECK(glUniform4fv(location, 1, glm::value_ptr(value)));
+        }
+    }
+}
+
+void Shader::setMat4(std::string_view name, const glm::mat4& value) {
+    setMat4(uniformLocation(name), value);
+}
+
+void Shader::setMat4(int location, const glm::mat4& value) {
+    if (updateShadow(location, glm::value_ptr(value), sizeof(value))) {
+        if (programUniformSupported()) {
+            GLCHECK(glProgramUniformMatrix4fv(mProgram.get(), location, 1, GL_FALSE, glm::value_ptr(value)));
+        } else {
+            use();
+            GLCHECK(glUniformMatrix4fv(location, 1, GL_FALSE, glm::value_ptr(value)));
+        }
+    }
+}
+
+int Shader::handleLocation(size_t slot, std::string_view name, unsigned int glslType) {
+    if (slot < mHandleLocations.size() && mHandleLocations[slot] != kUnresolved) {
+        return mHandleLocations[slot];
+    }
+    if (slot >= mHandleLocations.size()) {
+        mHandleLocations.resize(slot + 1, kUnresolved);
+    }
+    finishBuild();
+
+    const auto it { std::lower_bound(mUniforms.begin(), mUniforms.end(), name,
+        [](const UniformInfo& uniform, std::string_view key) { return std::string_view(uniform.name) < key; }) };
+    int location { -1 };
+    if (it != mUniforms.end() && it->name == name) {
+        // samplers are set with an int, everything else has to match exactly.
+        if (it->type == glslType || (glslType == GL_INT && isSampler(it->type))) {
+            location = it->location;
+        } else {
+            std::cout << "ERROR::SHADER::UNIFORM_TYPE_MISMATCH: " << name << " is declared as GL type 0x" << std::hex << it->type
+                      << " but set as 0x" << glslType << std::dec << std::endl;
+        }
+    }
+    // a missing or mismatched uniform resolves to -1, which the setters ignore.
+    mHandleLocations[slot] = location;
+    return location;
 }
 
-void Shader::setInt(const std::string& name, int value) const {
-    glUniform1i(glGetUniformLocation(ID, name.c_str()), value);
+bool Shader::updateShadow(int location, const void* value, size_t size) {
+    if (location < 0) {
+        return false;
+    }
+    if (static_cast<size_t>(location) >= mShadowSlots.size() || mShadowSlots[location].offset < 0) {
+        // array elements past the first and types without a shadow are always written.
+        return true;
+    }
+    const auto& slot { mShadowSlots[location] };
+    if (size != slot.components * sizeof(std::uint32_t)) {
+        // a setter for another type; GL reports the call itself, the shadow of the neighbours stays intact.
+        std::cout << "ERROR::SHADER::UNIFORM_SIZE_MISMATCH: location " << location << " holds " << slot.components
+                  << " components but was set with " << size / sizeof(std::uint32_t) << std::endl;
+        return true;
+    }
+    auto* shadow { mShadow.data() + slot.offset };
+    if (std::memcmp(shadow, value, size) == 0) {
+        return false;
+    }
+    std::memcpy(shadow, value, size);
+    return true;
 }
 
-void Shader::setFloat(const std::string& name, float value) const {
-    glUniform1f(glGetUniformLocation(ID, name.c_str()), value);
+void Shader::bindUniformBlock(std::string_view name, unsigned int binding, size_t expectedSize) {
+    finishBuild();
+    const auto it { std::find_if(mBlockBindings.begin(), mBlockBindings.end(),
+        [&](const BlockBinding& block) { return block.name == name; }) };
+    auto& block { it != mBlockBindings.end() ? *it : mBlockBindings.emplace_back() };
+    block = { std::string(name), binding, expectedSize };
+    applyBlockBinding(block);
 }
 
-void Shader::checkCompileErrors(unsigned int shader, std::string type) {
+void Shader::applyBlockBinding(const BlockBinding& block) {
+    const unsigned int index { GLCHECK(glGetUniformBlockIndex(mProgram.get(), block.name.c_str())) };
+    // not an error, the block may simply be unused by this program and optimized out.
+    if (index == GL_INVALID_INDEX) {
+        return;
+    }
+    GLCHECK(glUniformBlockBinding(mProgram.get(), index, block.binding));
+
+    if (block.expectedSize != 0) {
+        int size {};
+        GLCHECK(glGetActiveUniformBlockiv(mProgram.get(), index, GL_UNIFORM_BLOCK_DATA_SIZE, &size));
+        // drivers may or may not round the std140 size up to 16 bytes, and so may the C++ struct.
+        const auto roundUp { [](size_t bytes) { return (bytes + 15) / 16 * 16; } };
+        if (roundUp(static_cast<size_t>(size)) != roundUp(block.expectedSize)) {
+            std::cout << "ERROR::SHADER::UNIFORM_BLOCK_SIZE_MISMATCH: " << block.name << " is " << size
+                      << " bytes in GLSL but " << block.expectedSize << " bytes in C++" << std::endl;
+        }
+    }
+}
+
+const std::vector<Shader::AttributeInfo>& Shader::attributes() {
+    finishBuild();
+    return mAttributes;
+}
+
+void Shader::reflectAttributes() {
+    mAttributes.clear();
+
+    int count {};
+    int maxNameLength {};
+    GLCHECK(glGetProgramiv(mProgram.get(), GL_ACTIVE_ATTRIBUTES, &count));
+    GLCHECK(glGetProgramiv(mProgram.get(), GL_ACTIVE_ATTRIBUTE_MAX_LENGTH, &maxNameLength));
+
+    std::string name(static_cast<size_t>(std::max(maxNameLength, 1)), '\0');
+    for (int i = 0; i < count; i++) {
+        int length {};
+        int size {};
+        GLenum type {};
+        GLCHECK(glGetActiveAttrib(mProgram.get(), static_cast<GLuint>(i), maxNameLength, &length, &size, &type, name.data()));
+
+        std::string attributeName(name.data(), static_cast<size_t>(length));
+        const int location { GLCHECK(glGetAttribLocation(mProgram.get(), attributeName.c_str())) };
+        // built-ins such as gl_VertexID are active but have no location.
+        if (location < 0) {
+            continue;
+        }
+        mAttributes.push_back({ std::move(attributeName), location, type, size });
+    }
+
+    std::sort(mAttributes.begin(), mAttributes.end(),
+        [](const AttributeInfo& a, const AttributeInfo& b) { return a.location < b.location; });
+}
+
+void Shader::reflectUniforms() {
+    mUniforms.clear();
+
+    int count {};
+    int maxNameLength {};
+    GLCHECK(glGetProgramiv(mProgram.get(), GL_ACTIVE_UNIFORMS, &count));
+    GLCHECK(glGetProgramiv(mProgram.get(), GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxNameLength));
+
+    std::string name(static_cast<size_t>(std::max(maxNameLength, 1)), '\0');
+    for (int i = 0; i < count; i++) {
+        int length {};
+        int size {};
+        GLenum type {};
+        GLCHECK(glGetActiveUniform(mProgram.get(), static_cast<GLuint>(i), maxNameLength, &length, &size, &type, name.data()));
+
+        std::string uniformName(name.data(), static_cast<size_t>(length));
+        const int location { GLCHECK(glGetUniformLocation(mProgram.get(), uniformName.c_str())) };
+        // uniforms inside blocks have no location and are not set through glUniform*.
+        if (location < 0) {
+            continue;
+        }
+        // arrays are reported as "name[0]", but GL also accepts the bare "name".
+        if (uniformName.ends_with("[0]")) {
+            mUniforms.push_back({ uniformName.substr(0, uniformName.size() - 3), location, type, size });
+        }
+        mUniforms.push_back({ std::move(uniformName), location, type, size });
+    }
+
+    std::sort(mUniforms.begin(), mUniforms.end(),
+        [](const UniformInfo& a, const UniformInfo& b) { return a.name < b.name; });
+
+    // a new program may put the same names at other locations.
+    std::fill(mHandleLocations.begin(), mHandleLocations.end(), kUnresolved);
+
+    // one shadow slot per location, seeded with what the program holds right after linking:
+    // GLSL initializers and layout(binding = N) on samplers make that something other than zero.
+    // array uniforms only shadow their first element.
+    mShadow.clear();
+    mShadowSlots.clear();
+    for (const auto& uniform : mUniforms) {
+        const size_t components { shadowComponents(uniform.type) };
+        if (components == 0) {
+            continue;
+        }
+        if (static_cast<size_t>(uniform.location) >= mShadowSlots.size()) {
+            mShadowSlots.resize(static_cast<size_t>(uniform.location) + 1);
+        }
+        // "name" and "name[0]" share a location.
+        auto& slot { mShadowSlots[uniform.location] };
+        if (slot.offset < 0) {
+            slot = { static_cast<int>(mShadow.size()), static_cast<unsigned int>(components) };
+            mShadow.resize(mShadow.size() + components);
+            readUniform(mProgram.get(), uniform.location, uniform.type, mShadow.data() + slot.offset);
+        }
+    }
+}
+
+std::string Shader::binaryCacheKey(std::string_view vertexCode, std::string_view fragmentCode) {
+    if (sBinaryCacheDirectory.empty() || !programBinarySupported()) {
+        return {};
+    }
+    // a binary is only valid for the driver that produced it, so the driver strings are part of the key.
+    const auto glString { [](GLenum name) {
+        const auto value { reinterpret_cast<const char*>(GLCHECK(glGetString(name))) };
+        return std::string_view(value != nullptr ? value : "");
+    } };
+
+    std::uint64_t hash { kShaderHashSeed };
+    for (const std::string_view part : { vertexCode, fragmentCode,
+                                         glString(GL_VENDOR), glString(GL_RENDERER), glString(GL_VERSION) }) {
+        hash = shaderHash(part, hash);
+        // separator, so moving text from one part into the next changes the key.
+        hash = shaderHash(std::string_view("\0", 1), hash);
+    }
+
+    char name[17] {};
+    std::snprintf(name, sizeof(name), "%016llx", static_cast<unsigned long long>(hash));
+    return name;
+}
+
+bool Shader::loadProgramBinary(const std::string& key) {
+    if (key.empty()) {
+        return false;
+    }
+    const std::filesystem::path path { sBinaryCacheDirectory / (key + ".bin") };
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        return false;
+    }
+
+    std::uint32_t magic {};
+    GLenum format {};
+    file.read(reinterpret_cast<char*>(&magic), sizeof(magic));
+    file.read(reinterpret_cast<char*>(&format), sizeof(format));
+    const std::vector<char> binary { std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>() };
+    file.close();
+
+    if (magic == kBinaryCacheMagic && !binary.empty()) {
+        GlProgram program { GLCHECK(glCreateProgram()) };
+        GLCHECK(glProgramBinary(program.get(), format, binary.data(), static_cast<GLsizei>(binary.size())));
+        int success {};
+        GLCHECK(glGetProgramiv(program.get(), GL_LINK_STATUS, &success));
+        if (success) {
+            mProgram = std::move(program);
+            mBuildTimings.binaryBytes = binary.size();
+            return true;
+        }
+        // rejected, usually after a driver update; fall back to compiling from source.
+    }
+    std::error_code error;
+    std::filesystem::remove(path, error);
+    return false;
+}
+
+void Shader::storeProgramBinary(const std::string& key) {
+    if (key.empty()) {
+        return;
+    }
+    int length {};
+    GLCHECK(glGetProgramiv(mProgram.get(), GL_PROGRAM_BINARY_LENGTH, &length));
+    if (length <= 0) {
+        return;
+    }
+    std::vector<char> binary(static_cast<size_t>(length));
+    GLenum format {};
+    GLCHECK(glGetProgramBinary(mProgram.get(), length, &length, &format, binary.data()));
+
+    std::error_code error;
+    std::filesystem::create_directories(sBinaryCacheDirectory, error);
+    // write next to the final name and rename, so a crash never leaves a truncated binary behind.
+    const std::filesystem::path path { sBinaryCacheDirectory / (key + ".bin") };
+    std::filesystem::path temporaryPath { path };
+    temporaryPath += ".tmp";
+    {
+        std::ofstream file(temporaryPath, std::ios::binary | std::ios::trunc);
+        file.write(reinterpret_cast<const char*>(&kBinaryCacheMagic), sizeof(kBinaryCacheMagic));
+        file.write(reinterpret_cast<const char*>(&format), sizeof(format));
+        file.write(binary.data(), length);
+        if (!file) {
+            std::cout << "ERROR::SHADER::BINARY_CACHE_NOT_SUCCESSFULLY_WRITTEN: " << temporaryPath.string() << std::endl;
+            return;
+        }
+    }
+    std::filesystem::rename(temporaryPath, path, error);
+    mBuildTimings.binaryBytes = static_cast<size_t>(length);
+}
+
+void Shader::build(std::string_view vertexCode, std::string_view fragmentCode, const StageCompiler& compileStage) {
+    mBuildTimings.sourceBytes = vertexCode.size() + fragmentCode.size();
+    // reuse a program binary from an earlier run when the driver still accepts it
+    bool loaded {};
+    {
+        ShaderProfiler::ScopedTimer timer { mBuildTimings.binaryMs };
+        mBinaryCacheKey = binaryCacheKey(vertexCode, fragmentCode);
+        loaded = loadProgramBinary(mBinaryCacheKey);
+    }
+    if (loaded) {
+        mBuildTimings.fromBinaryCache = true;
+        ShaderProfiler::shared().record(mBuildTimings);
+        reflectUniforms();
+        reflectAttributes();
+        return;
+    }
+    // compile and link without asking for any status, which would make the driver finish first
+    {
+        ShaderProfiler::ScopedTimer timer { mBuildTimings.vertexCompileMs };
+        mBuild.vertex = compileStage(GL_VERTEX_SHADER, vertexCode);
+    }
+    {
+        ShaderProfiler::ScopedTimer timer { mBuildTimings.fragmentCompileMs };
+        mBuild.fragment = compileStage(GL_FRAGMENT_SHADER, fragmentCode);
+    }
+    ShaderProfiler::ScopedTimer timer { mBuildTimings.linkMs };
+    mBuild.program = GlProgram(GLCHECK(glCreateProgram()));
+    GLCHECK(glAttachShader(mBuild.program.get(), mBuild.vertex->id()));
+    GLCHECK(glAttachShader(mBuild.program.get(), mBuild.fragment->id()));
+    if (!mBinaryCacheKey.empty()) {
+        GLCHECK(glProgramParameteri(mBuild.program.get(), GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE));
+    }
+    GLCHECK(glLinkProgram(mBuild.program.get()));
+}
+
+void Shader::finishBuild() {
+    if (!mBuild.program) {
+        return;
+    }
+    mProgram = std::move(mBuild.program);
+    // the first status query waits for the driver to finish compiling and linking
+    bool linked {};
+    {
+        ShaderProfiler::ScopedTimer timer { mBuildTimings.statusMs };
+        checkCompileErrors(mBuild.vertex->id(), "VERTEX", mVertexFiles);
+        checkCompileErrors(mBuild.fragment->id(), "FRAGMENT", mFragmentFiles);
+        linked = checkCompileErrors(mProgram.get(), "PROGRAM");
+    }
+    if (linked) {
+        ShaderProfiler::ScopedTimer timer { mBuildTimings.binaryMs };
+        storeProgramBinary(mBinaryCacheKey);
+    }
+    ShaderProfiler::shared().record(mBuildTimings);
+    reflectUniforms();
+    reflectAttributes();
+    // detach the shaders as they're linked into our program now; the stages themselves stay
+    // alive with this Shader, and are deleted once no Shader built from them is left
+    GLCHECK(glDetachShader(mProgram.get(), mBuild.vertex->id()));
+    GLCHECK(glDetachShader(mProgram.get(), mBuild.fragment->id()));
+    mVertexStage = std::move(mBuild.vertex);
+    mFragmentStage = std::move(mBuild.fragment);
+    mBuild = {};
+}
+
+std::uint64_t Shader::nextSerial() {
+    static std::atomic<std::uint64_t> next { 1 };
+    return next++;
+}
+
+bool Shader::compileFinished(unsigned int program) {
+    if (!parallelCompileSupported()) {
+        // without the extension there is no way to ask, and the next status query simply waits.
+        return true;
+    }
+    int completed {};
+    GLCHECK(glGetProgramiv(program, GL_COMPLETION_STATUS_KHR, &completed));
+    return completed;
+}
+
+std::shared_ptr<const ShaderStage> Shader::compileStage(unsigned int type, std::string_view code) {
+    return std::make_shared<const ShaderStage>(type, code);
+}
+
+bool Shader::checkCompileErrors(unsigned int shader, std::string type, std::span<const std::filesystem::path> files) {
     int success;
     char infoLog[1024];
     if (type != "PROGRAM") {
-        glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
+        GLCHECK(glGetShaderiv(shader, GL_COMPILE_STATUS, &success));
         if (!success) {
-            glGetShaderInfoLog(shader, 1024, NULL, infoLog);
-            std::cout << "ERROR::SHADER_COMPILATION_ERROR of type: " << type << "\n" << infoLog << "\n -- --------------------------------------------------- -- " << std::endl;
+            GLCHECK(glGetShaderInfoLog(shader, 1024, NULL, infoLog));
+            std::cout << "ERROR::SHADER_COMPILATION_ERROR of type: " << type << "\n" << infoLog;
+            // the log names files by their #line source string number
+            for (size_t i = 0; i < files.size(); i++) {
+                std::cout << "  source " << i << ": " << files[i].string() << "\n";
+            }
+            std::cout << "\n -- --------------------------------------------------- -- " << std::endl;
         }
     } else {
-        glGetProgramiv(shader, GL_LINK_STATUS, &success);
+        GLCHECK(glGetProgramiv(shader, GL_LINK_STATUS, &success));
         if (!success) {
-            glGetProgramInfoLog(shader, 1024, NULL, infoLog);
+            GLCHECK(glGetProgramInfoLog(shader, 1024, NULL, infoLog));
             std::cout << "ERROR::PROGRAM_LINKING_ERROR of type: " << type << "\n" << infoLog << "\n -- --------------------------------------------------- -- " << std::endl;
         }
     }
+    return success;
 }
 
-Shader::~Shader() {
-    glDeleteProgram(ID);
-}
+Shader::Shader(Shader&&) noexcept = default;
+
+Shader& Shader::operator=(Shader&&) noexcept = default;
+
+Shader::~Shader() = default;
@@ -1,28 +1,299 @@
 #pragma once
 
+#include "ShaderPreprocessor.h"
+#include "ShaderProfiler.h"
+#include "ShaderStage.h"
+#include "Uniform.h"
+
+#include <GlHandle.h>
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <span>
+#include <string>
 #include <string_view>
+#include <type_traits>
+#include <vector>
+
+class ShaderWatcher;
+
+// vertex/fragment sources that are already in memory, e.g. from EmbeddedShaders.
+struct ShaderSource {
+    std::string_view vertex;
+    std::string_view fragment;
+};
 
 class Shader {
 public:
-    unsigned int ID;
-    // constructor generates the shader on the fly
+    // Blocking waits for the compile and link inside the constructor. Deferred only submits
+    // them, so many programs can compile in parallel; poll isReady() before using the shader.
+    enum class CompileMode {
+        Blocking,
+        Deferred,
+    };
+
+    // constructor generates the shader on the fly. #include directives in the files are
+    // expanded by ShaderPreprocessor::shared().
+    // ------------------------------------------------------------------------
+    Shader(const char* vertexPath, const char* fragmentPath, CompileMode mode = CompileMode::Blocking);
+    // same, with #defines injected after #version in the stages that use them (see ShaderVariants).
+    // ------------------------------------------------------------------------
+    Shader(const char* vertexPath, const char* fragmentPath, std::span<const ShaderPreprocessor::Define> defines,
+           CompileMode mode = CompileMode::Blocking);
+    // build from in-memory sources, without touching the file system. such a shader
+    // has no files to watch, so enableHotReload() does nothing for it.
     // ------------------------------------------------------------------------
-    Shader(const char* vertexPath, const char* fragmentPath);
-    // activate the shader
+    explicit Shader(const ShaderSource& source, CompileMode mode = CompileMode::Blocking);
+    // a Shader owns its program, so it can be moved (e.g. into a std::vector) but not copied.
+    // ------------------------------------------------------------------------
+    Shader(const Shader&) = delete;
+    Shader& operator=(const Shader&) = delete;
+    Shader(Shader&& other) noexcept;
+    Shader& operator=(Shader&& other) noexcept;
+    // directory where linked program binaries are kept between runs, keyed by a hash
+    // of both sources and the driver strings. an empty path (the default) disables the cache.
+    // ------------------------------------------------------------------------
+    static void setBinaryCacheDirectory(const std::filesystem::path& directory);
+    // number of driver threads for background compiles (GL_KHR_parallel_shader_compile).
+    // no-op when the extension is missing.
+    // ------------------------------------------------------------------------
+    static void setMaxCompilerThreads(unsigned int count);
+    // true once a Deferred build has finished, at which point its status is checked and
+    // its uniforms are reflected. with GL_KHR_parallel_shader_compile this never blocks,
+    // without it the first call waits for the driver. use() waits for the build as well.
+    // ------------------------------------------------------------------------
+    bool isReady();
+    // watch the files this shader was built from for edits.
+    // ------------------------------------------------------------------------
+    void enableHotReload();
+    // call once per frame. edited sources are read on the watcher thread and linked into a
+    // new program next to the current one, whose status is only checked on a later call, so
+    // the render loop never waits on the compiler. the new program replaces id() only if it
+    // linked; returns true when that happened, after which the shader has to be bound and
+    // its uniforms set again.
+    // ------------------------------------------------------------------------
+    bool reloadIfChanged();
+    // activate the shader. the bind goes through GlState, so it costs nothing when the
+    // program is already current.
     // ------------------------------------------------------------------------
     void use();
-    // utility uniform functions
+    // the GL program name. waits for an outstanding Deferred build, and changes when a hot
+    // reload succeeds.
+    // ------------------------------------------------------------------------
+    unsigned int id();
+    // for caches of per program objects (see VertexArrayCache), since GL recycles the name of a
+    // program a hot reload deleted. serial() is unique per Shader and follows it when moved;
+    // generation() changes whenever a reload replaces the program.
     // ------------------------------------------------------------------------
-    void setBool(const std::string& name, bool value) const;
+    std::uint64_t serial() const { return mSerial; }
+    unsigned int generation() const { return mGeneration; }
+    // bind no program at all, e.g. so a program pipeline takes effect (see ProgramPipelineCache).
     // ------------------------------------------------------------------------
-    void setInt(const std::string& name, int value) const;
+    static void unbind();
+    // location of an active uniform, resolved from the table built at link time. waits for an
+    // outstanding Deferred build, like id(). returns -1 for names the program does not use,
+    // which glUniform* ignores.
+    // ------------------------------------------------------------------------
+    int uniformLocation(std::string_view name);
+    // utility uniform functions. each program keeps a copy of the values it was given, so
+    // setting a uniform to the value it already has costs no GL call. with GL 4.1 or
+    // ARB_separate_shader_objects values go through glProgramUniform* and the bound program
+    // stays as it is; otherwise the shader is bound first (use()) so the value lands in this
+    // program, and it is still bound afterwards.
+    // ------------------------------------------------------------------------
+    void setBool(std::string_view name, bool value);
+    void setBool(int location, bool value);
+    // ------------------------------------------------------------------------
+    void setInt(std::string_view name, int value);
+    void setInt(int location, int value);
+    // ------------------------------------------------------------------------
+    void setFloat(std::string_view name, float value);
+    void setFloat(int location, float value);
+    // ------------------------------------------------------------------------
+    void setVec2(std::string_view name, const glm::vec2& value);
+    void setVec2(int location, const glm::vec2& value);
+    // ------------------------------------------------------------------------
+    void setVec3(std::string_view name, const glm::vec3& value);
+    void setVec3(int location, const glm::vec3& value);
+    // ------------------------------------------------------------------------
+    void setVec4(std::string_view name, const glm::vec4& value);
+    void setVec4(int location, const glm::vec4& value);
+    // ------------------------------------------------------------------------
+    void setMat4(std::string_view name, const glm::mat4& value);
+    void setMat4(int location, const glm::mat4& value);
+
+    // a vertex attribute the linked program reads.
+    struct AttributeInfo {
+        std::string name;
+        int location {};
+        unsigned int type {};
+        int size {};
+    };
+
+    // active vertex attributes sorted by location, reflected once after linking.
+    // ------------------------------------------------------------------------
+    const std::vector<AttributeInfo>& attributes();
+
+    // set a uniform through a compile time handle (see Uniform). the location is looked up
+    // the first time per program, together with a check that the GLSL type matches.
+    // ------------------------------------------------------------------------
+    template <typename U>
+    void set(const typename U::Type& value) {
+        const int location { handleLocation(U::slot(), U::kName, U::kGlslType) };
+        using T = typename U::Type;
+        if constexpr (std::is_same_v<T, bool>) {
+            setBool(location, value);
+        } else if constexpr (std::is_same_v<T, int>) {
+            setInt(location, value);
+        } else if constexpr (std::is_same_v<T, float>) {
+            setFloat(location, value);
+        } else if constexpr (std::is_same_v<T, glm::vec2>) {
+            setVec2(location, value);
+        } else if constexpr (std::is_same_v<T, glm::vec3>) {
+            setVec3(location, value);
+        } else if constexpr (std::is_same_v<T, glm::vec4>) {
+            setVec4(location, value);
+        } else {
+            setMat4(location, value);
+        }
+    }
+
+    // connect the named uniform block to a binding point (see UniformBlock). the binding
+    // is remembered and applied again after hot reloads. if expectedSize is given it is
+    // compared with the block size the driver reports, up to rounding to 16 bytes, which catches
+    // members missing on one side; offsets within the block need UNIFORM_BLOCK_OFFSET.
     // ------------------------------------------------------------------------
-    void setFloat(const std::string& name, float value) const;
+    void bindUniformBlock(std::string_view name, unsigned int binding, size_t expectedSize = 0);
 
     ~Shader();
 
 private:
+    struct UniformInfo {
+        std::string name;
+        int location {};
+        unsigned int type {};
+        int size {};
+    };
+
+    // where the shadow copy of one location lives in mShadow, and how many components it has.
+    struct ShadowSlot {
+        int offset { -1 };
+        unsigned int components {};
+    };
+
+    GlProgram mProgram;
+    std::uint64_t mSerial { nextSerial() };
+    unsigned int mGeneration {};
+
+    // active uniforms sorted by name so lookups are a binary search over string_views.
+    std::vector<UniformInfo> mUniforms;
+    std::vector<AttributeInfo> mAttributes;
+    // last value written to each uniform location, as raw 32 bit components. reflectUniforms
+    // seeds it with the values the program holds after linking, which are not always zero
+    // (initializers, sampler bindings). mShadowSlots maps a location to its components;
+    // locations that are not shadowed have an offset of -1.
+    std::vector<std::uint32_t> mShadow;
+    std::vector<ShadowSlot> mShadowSlots;
+    // locations of Uniform handles by slot, resolved on first use; kUnresolved until then.
+    static constexpr int kUnresolved { -2 };
+    std::vector<int> mHandleLocations;
+
+    struct BlockBinding {
+        std::string name;
+        unsigned int binding {};
+        size_t expectedSize {};
+    };
+
+    // uniform blocks connected through bindUniformBlock.
+    std::vector<BlockBinding> mBlockBindings;
+
+    // a program whose compile and link were submitted but not checked yet.
+    struct PendingProgram {
+        GlProgram program;
+        std::shared_ptr<const ShaderStage> vertex;
+        std::shared_ptr<const ShaderStage> fragment;
+    };
+
+    // where build() gets its compiled stages from; ShaderRegistry hands out shared ones.
+    using StageCompiler = std::function<std::shared_ptr<const ShaderStage>(unsigned int type, std::string_view code)>;
+
+    friend class ShaderRegistry;
+
+    static std::filesystem::path sBinaryCacheDirectory;
+
+    std::filesystem::path mVertexPath;
+    std::filesystem::path mFragmentPath;
+    std::vector<ShaderPreprocessor::Define> mDefines;
+    // files each stage was preprocessed from, indexed by #line source string number.
+    std::vector<std::filesystem::path> mVertexFiles;
+    std::vector<std::filesystem::path> mFragmentFiles;
+    std::unique_ptr<ShaderWatcher> mWatcher;
+    // the build of mProgram while a Deferred construction is outstanding. the program moves
+    // into mProgram once finishBuild has checked it.
+    PendingProgram mBuild {};
+    // the stages mProgram was linked from, kept for as long as this Shader lives so ShaderRegistry
+    // can link them into later programs that share a stage instead of compiling it again.
+    std::shared_ptr<const ShaderStage> mVertexStage;
+    std::shared_ptr<const ShaderStage> mFragmentStage;
+    std::string mBinaryCacheKey;
+    // a program being built from edited sources, see reloadIfChanged.
+    PendingProgram mPending {};
+    // timings of mBuild and mPending, recorded with ShaderProfiler once they are checked.
+    ShaderProfiler::Program mBuildTimings {};
+    ShaderProfiler::Program mPendingTimings {};
+
+    // for ShaderRegistry, which has already preprocessed the files to look the program up.
+    Shader(const char* vertexPath, const char* fragmentPath, std::span<const ShaderPreprocessor::Define> defines,
+           const ShaderPreprocessor::Result& vertex, const ShaderPreprocessor::Result& fragment, double readMs, CompileMode mode,
+           const StageCompiler& compileStage);
+    Shader(const ShaderSource& source, CompileMode mode, const StageCompiler& compileStage);
+
+    // start building from preprocessed files; the first step of the file based constructors.
+    // ------------------------------------------------------------------------
+    void buildFiles(const ShaderPreprocessor::Result& vertex, const ShaderPreprocessor::Result& fragment, CompileMode mode,
+                    const StageCompiler& compileStage);
+
+    // submit the build of mProgram, or load it from the binary cache.
+    // ------------------------------------------------------------------------
+    void build(std::string_view vertexCode, std::string_view fragmentCode, const StageCompiler& compileStage);
+    // check the status of an outstanding build and finish setting up the program.
+    // ------------------------------------------------------------------------
+    void finishBuild();
+    // whether a status query on the program would return without waiting.
+    // ------------------------------------------------------------------------
+    static bool compileFinished(unsigned int program);
+
+    // ------------------------------------------------------------------------
+    static std::uint64_t nextSerial();
+    // a new, unshared stage; the default StageCompiler.
+    // ------------------------------------------------------------------------
+    static std::shared_ptr<const ShaderStage> compileStage(unsigned int type, std::string_view code);
+
+    // program binary cache, see setBinaryCacheDirectory. an empty key means the cache is unusable.
+    // ------------------------------------------------------------------------
+    static std::string binaryCacheKey(std::string_view vertexCode, std::string_view fragmentCode);
+    bool loadProgramBinary(const std::string& key);
+    void storeProgramBinary(const std::string& key);
+    // query every active uniform once after glLinkProgram.
+    // ------------------------------------------------------------------------
+    void reflectUniforms();
+    // query every active vertex attribute once after glLinkProgram.
+    // ------------------------------------------------------------------------
+    void reflectAttributes();
+    // location of a Uniform handle in this program, resolving and type checking it on first use.
+    // ------------------------------------------------------------------------
+    int handleLocation(size_t slot, std::string_view name, unsigned int glslType);
+    // compare a value with the shadow copy of a location and record it. returns false
+    // when the location already holds exactly these bytes and the GL call can be skipped.
+    // ------------------------------------------------------------------------
+    bool updateShadow(int location, const void* value, size_t size);
+    // apply one block binding to the current program.
+    // ------------------------------------------------------------------------
+    void applyBlockBinding(const BlockBinding& block);
     // utility function for checking shader compilation/linking errors.
     // ------------------------------------------------------------------------
-    void checkCompileErrors(unsigned int shader, std::string type);
-};
\ No newline at end of file
+    bool checkCompileErrors(unsigned int shader, std::string type, std::span<const std::filesystem::path> files = {});
+};
@@ -0,0 +1,16 @@
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+
+// 64 bit FNV-1a, used to key shader sources in the binary cache and the registry.
+// Not cryptographic; only fast and stable across runs and platforms.
+constexpr std::uint64_t kShaderHashSeed { 14695981039346656037ull };
+
+constexpr std::uint64_t shaderHash(std::string_view data, std::uint64_t hash = kShaderHashSeed) {
+    for (const char c : data) {
+        hash ^= static_cast<unsigned char>(c);
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
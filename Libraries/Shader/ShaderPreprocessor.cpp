@@ -0,0 +1,282 @@
+#include "ShaderPreprocessor.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+
+namespace {
+    // deeper than this is almost certainly an include cycle the stack check missed (e.g. through symlinks).
+    constexpr size_t kMaxIncludeDepth { 32 };
+
+    std::string_view trimLeft(std::string_view text) {
+        const auto start { text.find_first_not_of(" \t") };
+        return start == std::string_view::npos ? std::string_view {} : text.substr(start);
+    }
+
+    // the argument of "#<directive> ..." if line is that directive, allowing spaces after the '#'.
+    bool matchDirective(std::string_view line, std::string_view directive, std::string_view& argument) {
+        line = trimLeft(line);
+        if (!line.starts_with('#')) {
+            return false;
+        }
+        line = trimLeft(line.substr(1));
+        if (!line.starts_with(directive)) {
+            return false;
+        }
+        argument = trimLeft(line.substr(directive.size()));
+        return true;
+    }
+
+    // the file name between "" or <> of an include argument.
+    std::string_view includeName(std::string_view argument) {
+        if (argument.size() < 2) {
+            return {};
+        }
+        const char close { argument.front() == '"' ? '"' : argument.front() == '<' ? '>' : '\0' };
+        const auto end { argument.find(close, 1) };
+        if (close == '\0' || end == std::string_view::npos) {
+            return {};
+        }
+        return argument.substr(1, end - 1);
+    }
+
+    bool isIdentifierChar(char c) {
+        return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_';
+    }
+
+    // whether name appears in source as a whole identifier.
+    bool mentions(std::string_view source, std::string_view name) {
+        for (auto at { source.find(name) }; at != std::string_view::npos; at = source.find(name, at + 1)) {
+            const auto end { at + name.size() };
+            if ((at == 0 || !isIdentifierChar(source[at - 1])) && (end == source.size() || !isIdentifierChar(source[end]))) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // whether a /* */ comment is still open at the end of line, given whether one was open at its start.
+    bool blockCommentOpenAfter(std::string_view line, bool open) {
+        for (size_t i = 0; i + 1 < line.size(); i++) {
+            if (open) {
+                if (line[i] == '*' && line[i + 1] == '/') {
+                    open = false;
+                    i++;
+                }
+            } else if (line[i] == '/' && line[i + 1] == '/') {
+                break;
+            } else if (line[i] == '/' && line[i + 1] == '*') {
+                open = true;
+                i++;
+            }
+        }
+        return open;
+    }
+
+    // whether source has a "#pragma once" outside of block comments.
+    bool hasPragmaOnce(std::string_view source) {
+        bool inBlockComment { false };
+        for (size_t start = 0; start < source.size();) {
+            const auto end { std::min(source.find('\n', start), source.size()) };
+            const auto line { source.substr(start, end - start) };
+            start = end + 1;
+
+            std::string_view argument;
+            if (!inBlockComment && matchDirective(line, "pragma", argument) && argument.starts_with("once")) {
+                return true;
+            }
+            inBlockComment = blockCommentOpenAfter(line, inBlockComment);
+        }
+        return false;
+    }
+
+    std::string cacheKey(const std::filesystem::path& path) {
+        std::error_code error;
+        const auto canonical { std::filesystem::weakly_canonical(path, error) };
+        return (error ? path : canonical).lexically_normal().string();
+    }
+}
+
+ShaderPreprocessor& ShaderPreprocessor::shared() {
+    static ShaderPreprocessor preprocessor;
+    return preprocessor;
+}
+
+void ShaderPreprocessor::addIncludeDirectory(const std::filesystem::path& directory) {
+    std::lock_guard lock(mMutex);
+    mIncludeDirectories.push_back(directory);
+}
+
+ShaderPreprocessor::Result ShaderPreprocessor::process(const std::filesystem::path& path, std::span<const Define> defines) {
+    std::lock_guard lock(mMutex);
+    Result result;
+    const std::string* contents { load(path, result) };
+    if (contents == nullptr) {
+        std::cout << "ERROR::SHADER::FILE_NOT_SUCCESSFULLY_READ: " << path.string() << std::endl;
+        result.success = false;
+        return result;
+    }
+    std::vector<std::filesystem::path> includeStack;
+    expand(*contents, path, result, includeStack, defines);
+    return result;
+}
+
+ShaderPreprocessor::Result ShaderPreprocessor::process(std::string_view source, const std::filesystem::path& name, std::span<const Define> defines) {
+    std::lock_guard lock(mMutex);
+    Result result;
+    std::vector<std::filesystem::path> includeStack;
+    expand(source, name, result, includeStack, defines);
+    return result;
+}
+
+const std::string* ShaderPreprocessor::load(const std::filesystem::path& path, Result& result) {
+    std::error_code error;
+    const auto writeTime { std::filesystem::last_write_time(path, error) };
+    if (error) {
+        return nullptr;
+    }
+
+    auto& cached { mCache[cacheKey(path)] };
+    if (cached.loaded && cached.writeTime == writeTime) {
+        result.reads.push_back({ path.generic_string(), 0.0, cached.contents.size(), true });
+        return &cached.contents;
+    }
+
+    ShaderProfiler::FileRead read { path.generic_string() };
+    {
+        ShaderProfiler::ScopedTimer timer { read.ms };
+        std::ifstream file(path, std::ios::binary | std::ios::ate);
+        if (!file) {
+            return nullptr;
+        }
+        // size the string up front and read straight into it, without an intermediate stream copy.
+        const auto size { static_cast<size_t>(file.tellg()) };
+        cached.contents.resize(size);
+        file.seekg(0);
+        file.read(cached.contents.data(), static_cast<std::streamsize>(size));
+    }
+    read.bytes = cached.contents.size();
+    result.reads.push_back(std::move(read));
+    cached.writeTime = writeTime;
+    cached.loaded = true;
+    return &cached.contents;
+}
+
+std::filesystem::path ShaderPreprocessor::resolveInclude(const std::filesystem::path& includingFile, const std::filesystem::path& name) const {
+    const auto besideIncluder { includingFile.parent_path() / name };
+    if (std::filesystem::exists(besideIncluder)) {
+        return besideIncluder;
+    }
+    for (const auto& directory : mIncludeDirectories) {
+        if (std::filesystem::exists(directory / name)) {
+            return directory / name;
+        }
+    }
+    return besideIncluder;
+}
+
+void ShaderPreprocessor::expand(std::string_view source, const std::filesystem::path& path, Result& result,
+                                std::vector<std::filesystem::path>& includeStack, std::span<const Define> defines) {
+    const size_t fileIndex { result.files.size() };
+    result.files.push_back(path);
+    includeStack.push_back(path);
+
+    // only the top level file carries #version, and the defines have to follow it directly. which
+    // defines go there is only known once the whole stage is expanded, so the place is remembered.
+    bool injectDefines { includeStack.size() == 1 };
+    size_t definesAt { std::string::npos };
+    const auto emitDefines { [&](size_t nextLine) {
+        definesAt = result.source.size();
+        result.source += "#line " + std::to_string(nextLine) + ' ' + std::to_string(fileIndex) + '\n';
+        injectDefines = false;
+    } };
+    if (includeStack.size() > 1) {
+        result.source += "#line 1 " + std::to_string(fileIndex) + '\n';
+    }
+
+    size_t lineNumber { 0 };
+    bool inBlockComment { false };
+    for (size_t start = 0; start < source.size();) {
+        const auto end { std::min(source.find('\n', start), source.size()) };
+        const auto line { source.substr(start, end - start) };
+        start = end + 1;
+        lineNumber++;
+
+        // directives inside /* */ are commented out; the lines are kept as they are.
+        const bool commented { inBlockComment };
+        inBlockComment = blockCommentOpenAfter(line, inBlockComment);
+        if (commented) {
+            result.source.append(line);
+            result.source += '\n';
+            continue;
+        }
+
+        std::string_view argument;
+        if (matchDirective(line, "version", argument)) {
+            result.source.append(line);
+            result.source += '\n';
+            if (injectDefines) {
+                emitDefines(lineNumber + 1);
+            }
+            continue;
+        }
+        if (injectDefines && !trimLeft(line).empty() && !trimLeft(line).starts_with("//") && !trimLeft(line).starts_with("/*")) {
+            // no #version before the first statement; the defines go at the top instead.
+            emitDefines(lineNumber);
+        }
+        if (matchDirective(line, "pragma", argument) && argument.starts_with("once")) {
+            // keep an empty line so the following line numbers stay right.
+            result.source += '\n';
+            continue;
+        }
+        if (!matchDirective(line, "include", argument)) {
+            result.source.append(line);
+            result.source += '\n';
+            continue;
+        }
+
+        const auto name { includeName(argument) };
+        const auto includePath { resolveInclude(path, name) };
+        const auto key { cacheKey(includePath) };
+        const bool cyclic { std::any_of(includeStack.begin(), includeStack.end(),
+            [&](const std::filesystem::path& open) { return cacheKey(open) == key; }) };
+        const std::string* contents { name.empty() ? nullptr : load(includePath, result) };
+
+        if (cyclic || includeStack.size() >= kMaxIncludeDepth) {
+            std::cout << "ERROR::SHADER_PREPROCESSOR::RECURSIVE_INCLUDE: " << path.string() << '(' << lineNumber << "): " << argument << std::endl;
+            result.success = false;
+        } else if (contents == nullptr) {
+            std::cout << "ERROR::SHADER_PREPROCESSOR::INCLUDE_NOT_FOUND: " << path.string() << '(' << lineNumber << "): " << argument << std::endl;
+            result.success = false;
+        } else {
+            const bool includedBefore { std::any_of(result.files.begin(), result.files.end(),
+                [&](const std::filesystem::path& file) { return cacheKey(file) == key; }) };
+            // "#pragma once" files are expanded only the first time they are seen.
+            const bool once { includedBefore && hasPragmaOnce(*contents) };
+            if (once) {
+                result.source += '\n';
+            } else {
+                // copy, the cache entry may be replaced while the included file expands its own includes.
+                const std::string included { *contents };
+                expand(included, includePath, result, includeStack, {});
+                result.source += "#line " + std::to_string(lineNumber + 1) + ' ' + std::to_string(fileIndex) + '\n';
+            }
+        }
+    }
+
+    if (injectDefines) {
+        emitDefines(lineNumber + 1);
+    }
+    if (definesAt != std::string::npos) {
+        // a define the stage never mentions cannot change it, and leaving it out keeps the stage
+        // identical across variants that differ only in the other stage's features.
+        std::string injected;
+        for (const auto& define : defines) {
+            if (mentions(std::string_view(result.source).substr(definesAt), define.name)) {
+                injected += "#define " + define.name + ' ' + define.value + '\n';
+            }
+        }
+        result.source.insert(definesAt, injected);
+    }
+    includeStack.pop_back();
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include "ShaderProfiler.h"
+
+#include <filesystem>
+#include <mutex>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// Expands #include "file" directives and injects #defines into GLSL sources before
+// they reach glShaderSource. A define is only injected into sources that mention its name. Every file read is cached by path and modification time,
+// so building many programs that share headers reads each header only once.
+// Safe to use from several threads (the hot reload watcher preprocesses off the render thread).
+class ShaderPreprocessor {
+public:
+    struct Define {
+        std::string name;
+        std::string value;
+    };
+
+    struct Result {
+        std::string source;
+        // every file that went into source. "#line N i" directives refer to files[i],
+        // which is also the source string number drivers print in compile errors.
+        std::vector<std::filesystem::path> files;
+        // every load from disk or the cache, for ShaderProfiler.
+        std::vector<ShaderProfiler::FileRead> reads;
+        bool success { true };
+    };
+
+    // the instance Shader uses for its file based constructor.
+    // ------------------------------------------------------------------------
+    static ShaderPreprocessor& shared();
+
+    // directories searched for includes that are not found next to the including file.
+    // ------------------------------------------------------------------------
+    void addIncludeDirectory(const std::filesystem::path& directory);
+    // preprocess a file from disk.
+    // ------------------------------------------------------------------------
+    Result process(const std::filesystem::path& path, std::span<const Define> defines = {});
+    // preprocess a source that is already in memory. includes are resolved relative to name.
+    // ------------------------------------------------------------------------
+    Result process(std::string_view source, const std::filesystem::path& name, std::span<const Define> defines = {});
+
+private:
+    struct CachedFile {
+        std::filesystem::file_time_type writeTime {};
+        std::string contents;
+        // contents holds the file as of writeTime; empty files are valid contents too.
+        bool loaded {};
+    };
+
+    std::mutex mMutex;
+    std::vector<std::filesystem::path> mIncludeDirectories;
+    std::unordered_map<std::string, CachedFile> mCache;
+
+    // contents of a file, read again only when its modification time changed. nullptr if unreadable.
+    // the time the read took goes into result.reads.
+    // ------------------------------------------------------------------------
+    const std::string* load(const std::filesystem::path& path, Result& result);
+    std::filesystem::path resolveInclude(const std::filesystem::path& includingFile, const std::filesystem::path& name) const;
+    void expand(std::string_view source, const std::filesystem::path& path, Result& result,
+                std::vector<std::filesystem::path>& includeStack, std::span<const Define> defines);
+};
@@ -0,0 +1,101 @@
+#include "ShaderProfiler.h"
+
+#include <fstream>
+#include <iostream>
+#include <string_view>
+
+namespace {
+    void writeString(std::ostream& out, std::string_view text) {
+        out << '"';
+        for (const char c : text) {
+            switch (c) {
+            case '"': out << "\\\""; break;
+            case '\\': out << "\\\\"; break;
+            case '\n': out << "\\n"; break;
+            case '\t': out << "\\t"; break;
+            default: out << c; break;
+            }
+        }
+        out << '"';
+    }
+}
+
+double ShaderProfiler::Program::totalMs() const {
+    return readMs + vertexCompileMs + fragmentCompileMs + linkMs + statusMs + binaryMs;
+}
+
+ShaderProfiler& ShaderProfiler::shared() {
+    static ShaderProfiler profiler;
+    return profiler;
+}
+
+void ShaderProfiler::record(const Program& program) {
+    std::lock_guard lock { mMutex };
+    mPrograms.push_back(program);
+}
+
+std::vector<ShaderProfiler::Program> ShaderProfiler::programs() const {
+    std::lock_guard lock { mMutex };
+    return mPrograms;
+}
+
+void ShaderProfiler::clear() {
+    std::lock_guard lock { mMutex };
+    mPrograms.clear();
+}
+
+bool ShaderProfiler::writeReport(const std::filesystem::path& path) const {
+    const auto programs { this->programs() };
+
+    Program total {};
+    for (const auto& program : programs) {
+        total.readMs += program.readMs;
+        total.vertexCompileMs += program.vertexCompileMs;
+        total.fragmentCompileMs += program.fragmentCompileMs;
+        total.linkMs += program.linkMs;
+        total.statusMs += program.statusMs;
+        total.binaryMs += program.binaryMs;
+        total.sourceBytes += program.sourceBytes;
+        total.binaryBytes += program.binaryBytes;
+    }
+
+    std::ofstream file(path, std::ios::trunc);
+    if (!file) {
+        std::cout << "ERROR::SHADER::PROFILE_REPORT_NOT_SUCCESSFULLY_WRITTEN: " << path.string() << std::endl;
+        return false;
+    }
+
+    const auto writeTimes { [&file](const Program& program) {
+        file << "\"readMs\": " << program.readMs
+             << ", \"vertexCompileMs\": " << program.vertexCompileMs
+             << ", \"fragmentCompileMs\": " << program.fragmentCompileMs
+             << ", \"linkMs\": " << program.linkMs
+             << ", \"statusMs\": " << program.statusMs
+             << ", \"binaryMs\": " << program.binaryMs
+             << ", \"totalMs\": " << program.totalMs()
+             << ", \"sourceBytes\": " << program.sourceBytes
+             << ", \"binaryBytes\": " << program.binaryBytes;
+    } };
+
+    file << "{\n  \"programs\": [";
+    for (size_t i = 0; i < programs.size(); i++) {
+        const auto& program { programs[i] };
+        file << (i == 0 ? "\n" : ",\n") << "    { \"name\": ";
+        writeString(file, program.name);
+        file << std::boolalpha << ", \"deferred\": " << program.deferred << ", \"reload\": " << program.reload
+             << ", \"fromBinaryCache\": " << program.fromBinaryCache << ", ";
+        writeTimes(program);
+        file << ", \"files\": [";
+        for (size_t j = 0; j < program.files.size(); j++) {
+            const auto& read { program.files[j] };
+            file << (j == 0 ? " " : ", ") << "{ \"path\": ";
+            writeString(file, read.path);
+            file << ", \"ms\": " << read.ms << ", \"bytes\": " << read.bytes << ", \"cached\": " << read.cached << " }";
+        }
+        file << " ] }";
+    }
+    file << "\n  ],\n  \"total\": { \"programs\": " << programs.size() << ", ";
+    writeTimes(total);
+    file << " }\n}\n";
+    return static_cast<bool>(file);
+}
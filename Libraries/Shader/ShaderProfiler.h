@@ -0,0 +1,81 @@
+#pragma once
+
+#include <chrono>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Where the time of building shader programs goes. Every Shader times the reads, compiles,
+// link and status queries of its build and hands them to ShaderProfiler::shared() once the
+// program is finished; writeReport dumps everything as JSON, e.g. at shutdown.
+//
+// glCompileShader and glLinkProgram only submit work. Drivers that compile in the background
+// do it by the time the status is queried, so for them statusMs is where the compile really shows.
+class ShaderProfiler {
+public:
+    // one file the preprocessor needed for a program. a cache hit took no read, so its ms is 0.
+    struct FileRead {
+        std::string path;
+        double ms {};
+        size_t bytes {};
+        bool cached {};
+    };
+
+    struct Program {
+        // the source files, or a hash for in-memory sources.
+        std::string name;
+        // built with CompileMode::Deferred, so statusMs was spent whenever the program was first needed.
+        bool deferred {};
+        // a hot reload rebuilt the program; its files were read on the watcher thread.
+        bool reload {};
+        // linked from the program binary cache instead of compiled.
+        bool fromBinaryCache {};
+        // preprocessing both stages, the file reads in files included.
+        double readMs {};
+        double vertexCompileMs {};
+        double fragmentCompileMs {};
+        double linkMs {};
+        double statusMs {};
+        // loading or storing the program binary.
+        double binaryMs {};
+        size_t sourceBytes {};
+        size_t binaryBytes {};
+        // in the order the preprocessor asked for them, vertex stage first.
+        std::vector<FileRead> files;
+
+        double totalMs() const;
+    };
+
+    // adds the wall time of its scope to a counter in milliseconds.
+    class ScopedTimer {
+    public:
+        explicit ScopedTimer(double& milliseconds) : mMilliseconds { milliseconds } {}
+        ScopedTimer(const ScopedTimer&) = delete;
+        ScopedTimer& operator=(const ScopedTimer&) = delete;
+        ~ScopedTimer() {
+            mMilliseconds += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - mStart).count();
+        }
+
+    private:
+        double& mMilliseconds;
+        std::chrono::steady_clock::time_point mStart { std::chrono::steady_clock::now() };
+    };
+
+    static ShaderProfiler& shared();
+
+    // ------------------------------------------------------------------------
+    void record(const Program& program);
+    // every program recorded so far, in the order they finished.
+    // ------------------------------------------------------------------------
+    std::vector<Program> programs() const;
+    // ------------------------------------------------------------------------
+    void clear();
+    // per program timings plus the totals of each phase. returns false if the file could not be written.
+    // ------------------------------------------------------------------------
+    bool writeReport(const std::filesystem::path& path) const;
+
+private:
+    mutable std::mutex mMutex;
+    std::vector<Program> mPrograms;
+};
@@ -0,0 +1,71 @@
+#include "ShaderRegistry.h"
+#include "ShaderProfiler.h"
+
+#include <algorithm>
+#include <string>
+
+ShaderRegistry& ShaderRegistry::shared() {
+    static ShaderRegistry registry;
+    return registry;
+}
+
+std::shared_ptr<Shader> ShaderRegistry::acquire(const std::filesystem::path& vertexPath, const std::filesystem::path& fragmentPath,
+                                                std::span<const ShaderPreprocessor::Define> defines, Shader::CompileMode mode) {
+    // the expanded sources are the key, and a new Shader is built from them as they are.
+    double readMs {};
+    ShaderPreprocessor::Result vertex;
+    ShaderPreprocessor::Result fragment;
+    {
+        ShaderProfiler::ScopedTimer timer { readMs };
+        vertex = ShaderPreprocessor::shared().process(vertexPath, defines);
+        fragment = ShaderPreprocessor::shared().process(fragmentPath, defines);
+    }
+    return findOrCreate(vertex.source, fragment.source, [&](const Shader::StageCompiler& compileStage) {
+        return std::shared_ptr<Shader>(new Shader(vertexPath.string().c_str(), fragmentPath.string().c_str(), defines, vertex, fragment,
+                                                  readMs, mode, compileStage));
+    });
+}
+
+std::shared_ptr<Shader> ShaderRegistry::acquire(const ShaderSource& source, Shader::CompileMode mode) {
+    return findOrCreate(source.vertex, source.fragment, [&](const Shader::StageCompiler& compileStage) {
+        return std::shared_ptr<Shader>(new Shader(source, mode, compileStage));
+    });
+}
+
+size_t ShaderRegistry::programCount() const {
+    return std::count_if(mPrograms.begin(), mPrograms.end(), [](const auto& entry) { return !entry.second.expired(); });
+}
+
+size_t ShaderRegistry::stageCount() const {
+    return std::count_if(mStages.begin(), mStages.end(), [](const auto& entry) { return !entry.second.expired(); });
+}
+
+template <typename Create>
+std::shared_ptr<Shader> ShaderRegistry::findOrCreate(std::string_view vertexCode, std::string_view fragmentCode, Create&& create) {
+    std::string key { vertexCode };
+    key += '\0';
+    key += fragmentCode;
+    auto& entry { mPrograms[key] };
+    if (auto shader { entry.lock() }) {
+        return shader;
+    }
+    auto shader { create([this](unsigned int type, std::string_view code) { return stage(type, code); }) };
+    entry = shader;
+    // forget programs and stages that died since, so the maps do not grow with every reload of a scene.
+    std::erase_if(mPrograms, [](const auto& program) { return program.second.expired(); });
+    std::erase_if(mStages, [](const auto& stage) { return stage.second.expired(); });
+    return shader;
+}
+
+std::shared_ptr<const ShaderStage> ShaderRegistry::stage(unsigned int type, std::string_view code) {
+    std::string key { std::to_string(type) };
+    key += '\0';
+    key += code;
+    auto& entry { mStages[key] };
+    auto stage { entry.lock() };
+    if (!stage) {
+        stage = std::make_shared<const ShaderStage>(type, code);
+        entry = stage;
+    }
+    return stage;
+}
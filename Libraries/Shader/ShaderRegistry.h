@@ -0,0 +1,45 @@
+#pragma once
+
+#include "Shader.h"
+#include "ShaderPreprocessor.h"
+#include "ShaderStage.h"
+
+#include <filesystem>
+#include <memory>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+// Process wide cache of linked programs keyed by the content of their preprocessed sources.
+// Asking twice for the same vertex/fragment pair (from the same or from different files)
+// returns the same reference counted Shader; the program is deleted with its last handle.
+// Compiled stages are shared as well for as long as any Shader built from them is alive, so
+// programs that only differ in one stage (e.g. ShaderVariants) compile the other one once.
+// Defines only reach the stages that mention them, see ShaderPreprocessor.
+class ShaderRegistry {
+public:
+    static ShaderRegistry& shared();
+
+    // ------------------------------------------------------------------------
+    std::shared_ptr<Shader> acquire(const std::filesystem::path& vertexPath, const std::filesystem::path& fragmentPath,
+                                    std::span<const ShaderPreprocessor::Define> defines = {},
+                                    Shader::CompileMode mode = Shader::CompileMode::Blocking);
+    // ------------------------------------------------------------------------
+    std::shared_ptr<Shader> acquire(const ShaderSource& source, Shader::CompileMode mode = Shader::CompileMode::Blocking);
+
+    // live programs and stages, for diagnostics.
+    // ------------------------------------------------------------------------
+    size_t programCount() const;
+    size_t stageCount() const;
+
+private:
+    // keyed by the sources themselves rather than a hash of them, so two programs can never be
+    // mixed up. stages are owned by the Shaders linked from them and freed with the last one.
+    std::unordered_map<std::string, std::weak_ptr<Shader>> mPrograms;
+    std::unordered_map<std::string, std::weak_ptr<const ShaderStage>> mStages;
+
+    template <typename Create>
+    std::shared_ptr<Shader> findOrCreate(std::string_view vertexCode, std::string_view fragmentCode, Create&& create);
+    std::shared_ptr<const ShaderStage> stage(unsigned int type, std::string_view code);
+};
@@ -0,0 +1,13 @@
+#include "ShaderStage.h"
+
+#include <GlDebug.h>
+#include <glad/glad.h>
+
+ShaderStage::ShaderStage(unsigned int type, std::string_view source) : mType { type } {
+    // pass the length explicitly so views into larger buffers need no terminating copy
+    const char* code = source.data();
+    const int length { static_cast<int>(source.size()) };
+    mShader.reset(GLCHECK(glCreateShader(type)));
+    GLCHECK(glShaderSource(mShader.get(), 1, &code, &length));
+    GLCHECK(glCompileShader(mShader.get()));
+}
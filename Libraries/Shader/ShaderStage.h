@@ -0,0 +1,20 @@
+#pragma once
+
+#include <GlHandle.h>
+
+#include <string_view>
+
+// One compiled shader object (vertex, fragment, ...). The compile is only submitted in the
+// constructor; nothing waits for it until a program that uses the stage checks its status.
+// Shared through std::shared_ptr so several programs can link the same stage, see ShaderRegistry.
+class ShaderStage {
+public:
+    ShaderStage(unsigned int type, std::string_view source);
+
+    unsigned int id() const { return mShader.get(); }
+    unsigned int type() const { return mType; }
+
+private:
+    GlShader mShader;
+    unsigned int mType {};
+};
@@ -0,0 +1,75 @@
+#include "ShaderVariants.h"
+#include "ShaderRegistry.h"
+
+#include <algorithm>
+#include <iostream>
+
+ShaderVariants::ShaderVariants(std::filesystem::path vertexPath, std::filesystem::path fragmentPath,
+                               std::vector<ShaderPreprocessor::Define> features)
+    : mVertexPath { std::move(vertexPath) }, mFragmentPath { std::move(fragmentPath) }, mFeatures { std::move(features) } {
+    if (mFeatures.size() > kMaxFeatures) {
+        std::cout << "ERROR::SHADER_VARIANTS::TOO_MANY_FEATURES: " << mFeatures.size() << " > " << kMaxFeatures << std::endl;
+        mFeatures.resize(kMaxFeatures);
+    }
+}
+
+ShaderVariants::Key ShaderVariants::key(std::initializer_list<std::string_view> enabled) const {
+    Key result;
+    for (const auto feature : enabled) {
+        // "NAME=value" selects by value as well, a bare name takes the first feature of that name.
+        const auto separator { feature.find('=') };
+        const auto name { feature.substr(0, separator) };
+        const auto it { std::find_if(mFeatures.begin(), mFeatures.end(), [&](const ShaderPreprocessor::Define& define) {
+            return define.name == name && (separator == std::string_view::npos || define.value == feature.substr(separator + 1));
+        }) };
+        if (it == mFeatures.end()) {
+            std::cout << "ERROR::SHADER_VARIANTS::UNKNOWN_FEATURE: " << feature << std::endl;
+            continue;
+        }
+        // two values of one define would not compile; the later request wins.
+        for (size_t i = 0; i < mFeatures.size(); i++) {
+            if (result.test(i) && mFeatures[i].name == name) {
+                std::cout << "ERROR::SHADER_VARIANTS::CONFLICTING_FEATURES: " << feature << " replaces " << mFeatures[i].name << '='
+                          << mFeatures[i].value << std::endl;
+                result.reset(i);
+            }
+        }
+        result.set(static_cast<size_t>(it - mFeatures.begin()));
+    }
+    return result;
+}
+
+Shader& ShaderVariants::get(Key key) {
+    return compile(key, Shader::CompileMode::Blocking);
+}
+
+void ShaderVariants::prefetch(Key key) {
+    compile(key, Shader::CompileMode::Deferred);
+}
+
+size_t ShaderVariants::compiledCount() const {
+    return mVariants.size();
+}
+
+Shader& ShaderVariants::compile(Key key, Shader::CompileMode mode) {
+    auto& variant { mVariants[key] };
+    if (!variant) {
+        std::vector<ShaderPreprocessor::Define> defines;
+        for (size_t i = 0; i < mFeatures.size(); i++) {
+            if (!key.test(i)) {
+                continue;
+            }
+            // a key put together by hand may still hold two values of one define; keep the first.
+            const bool defined { std::any_of(defines.begin(), defines.end(),
+                [&](const ShaderPreprocessor::Define& define) { return define.name == mFeatures[i].name; }) };
+            if (defined) {
+                std::cout << "ERROR::SHADER_VARIANTS::CONFLICTING_FEATURES: " << mFeatures[i].name << '=' << mFeatures[i].value
+                          << " ignored" << std::endl;
+                continue;
+            }
+            defines.push_back(mFeatures[i]);
+        }
+        variant = ShaderRegistry::shared().acquire(mVertexPath, mFragmentPath, defines, mode);
+    }
+    return *variant;
+}
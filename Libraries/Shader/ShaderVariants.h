@@ -0,0 +1,53 @@
+#pragma once
+
+#include "Shader.h"
+#include "ShaderPreprocessor.h"
+
+#include <bitset>
+#include <filesystem>
+#include <initializer_list>
+#include <memory>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// Permutations of one vertex/fragment pair, selected by a bitset of feature #defines.
+// A variant is compiled the first time it is asked for and cached from then on, so
+// permutations that are never drawn never cost a compile.
+class ShaderVariants {
+public:
+    static constexpr size_t kMaxFeatures { 32 };
+    using Key = std::bitset<kMaxFeatures>;
+
+    // bit i of a key enables features[i]. a feature may carry a value, e.g. { "MIX_FACTOR", "0.5" };
+    // features sharing a name are alternative values of one define, and a key enables at most one of them.
+    // ------------------------------------------------------------------------
+    ShaderVariants(std::filesystem::path vertexPath, std::filesystem::path fragmentPath,
+                   std::vector<ShaderPreprocessor::Define> features);
+
+    // key with the named features enabled, e.g. key({ "ALPHA_TEST", "MIX_FACTOR=0.75" }). "NAME=value"
+    // picks one of several values declared for a name, a bare name picks the first one declared.
+    // unknown names are reported and ignored.
+    // ------------------------------------------------------------------------
+    Key key(std::initializer_list<std::string_view> enabled) const;
+    // the program for a key, compiled now if it was never requested before. like any other
+    // Shader it has to be bound with use() before drawing.
+    // ------------------------------------------------------------------------
+    Shader& get(Key key);
+    // start compiling a variant without waiting for it (Shader::CompileMode::Deferred),
+    // e.g. for variants that will be needed a few frames from now.
+    // ------------------------------------------------------------------------
+    void prefetch(Key key);
+    // number of variants compiled so far.
+    // ------------------------------------------------------------------------
+    size_t compiledCount() const;
+
+private:
+    std::filesystem::path mVertexPath;
+    std::filesystem::path mFragmentPath;
+    std::vector<ShaderPreprocessor::Define> mFeatures;
+    // variants come from ShaderRegistry, so they share the stages their features do not touch.
+    std::unordered_map<Key, std::shared_ptr<Shader>> mVariants;
+
+    Shader& compile(Key key, Shader::CompileMode mode);
+};
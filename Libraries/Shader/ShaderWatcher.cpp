@@ -0,0 +1,169 @@
+#include "ShaderWatcher.h"
+
+#include <chrono>
+#include <iostream>
+#include <utility>
+
+#ifdef __linux__
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+namespace {
+    using namespace std::chrono_literals;
+
+    // how often the stop token (and, without inotify, the files) are checked.
+    constexpr auto kPollInterval { 100ms };
+    // editors often write a file in several steps; wait for them to settle before reading.
+    constexpr auto kSettleDelay { 50ms };
+
+#ifdef __linux__
+
+    // one inotify instance for the lifetime of the watcher thread, so saves that happen while
+    // the sources are being read stay queued instead of being missed between two waits.
+    class ChangeMonitor {
+    public:
+        explicit ChangeMonitor(const std::vector<std::filesystem::path>& files) : mFd { inotify_init1(IN_NONBLOCK | IN_CLOEXEC) } {
+            if (mFd < 0) {
+                std::cout << "ERROR::SHADER_WATCHER::INOTIFY_INIT_FAILED" << std::endl;
+                return;
+            }
+            // watch the directories rather than the files, since many editors save by renaming a new file over the old one.
+            for (const auto& file : files) {
+                const auto directory { file.has_parent_path() ? file.parent_path() : std::filesystem::path(".") };
+                const int wd { inotify_add_watch(mFd, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE) };
+                if (wd >= 0) {
+                    mWatches.emplace_back(wd, file.filename());
+                }
+            }
+        }
+        ChangeMonitor(const ChangeMonitor&) = delete;
+        ChangeMonitor& operator=(const ChangeMonitor&) = delete;
+        ~ChangeMonitor() {
+            if (mFd >= 0) {
+                close(mFd);
+            }
+        }
+
+        // block until a watched file changed or a stop is requested.
+        void wait(std::stop_token stopToken) {
+            if (mFd < 0) {
+                std::this_thread::sleep_for(kPollInterval);
+                return;
+            }
+            while (!stopToken.stop_requested()) {
+                pollfd descriptor { mFd, POLLIN, 0 };
+                if (poll(&descriptor, 1, static_cast<int>(kPollInterval.count())) > 0 && readEvents()) {
+                    return;
+                }
+            }
+        }
+
+        // forget the events queued so far; the read that follows covers them.
+        void drain() {
+            alignas(inotify_event) char buffer[4096];
+            while (mFd >= 0 && read(mFd, buffer, sizeof(buffer)) > 0) {
+            }
+        }
+
+    private:
+        int mFd { -1 };
+        std::vector<std::pair<int, std::filesystem::path>> mWatches;
+
+        // read one batch of queued events. true if any of them was about a watched file.
+        bool readEvents() {
+            alignas(inotify_event) char buffer[4096];
+            const ssize_t length { read(mFd, buffer, sizeof(buffer)) };
+            bool changed { false };
+            for (ssize_t offset = 0; offset < length;) {
+                const auto event { reinterpret_cast<const inotify_event*>(buffer + offset) };
+                for (const auto& [wd, name] : mWatches) {
+                    if (event->len > 0 && event->wd == wd && name == event->name) {
+                        changed = true;
+                    }
+                }
+                offset += static_cast<ssize_t>(sizeof(inotify_event) + event->len);
+            }
+            return changed;
+        }
+    };
+
+#else
+
+    // modification times, compared with the ones seen last rather than at the start of each
+    // wait, so edits made while the sources are being read are still noticed.
+    class ChangeMonitor {
+    public:
+        explicit ChangeMonitor(const std::vector<std::filesystem::path>& files) : mFiles { files }, mWriteTimes { writeTimes() } {}
+
+        // block until a watched file changed or a stop is requested.
+        void wait(std::stop_token stopToken) {
+            while (!stopToken.stop_requested()) {
+                std::this_thread::sleep_for(kPollInterval);
+                if (writeTimes() != mWriteTimes) {
+                    return;
+                }
+            }
+        }
+
+        // take the current times as seen; the read that follows covers them.
+        void drain() {
+            mWriteTimes = writeTimes();
+        }
+
+    private:
+        const std::vector<std::filesystem::path>& mFiles;
+        std::vector<std::filesystem::file_time_type> mWriteTimes;
+
+        std::vector<std::filesystem::file_time_type> writeTimes() const {
+            std::vector<std::filesystem::file_time_type> times;
+            for (const auto& file : mFiles) {
+                std::error_code error;
+                times.push_back(std::filesystem::last_write_time(file, error));
+            }
+            return times;
+        }
+    };
+
+#endif
+}
+
+ShaderWatcher::ShaderWatcher(std::vector<std::filesystem::path> files, Loader load) : mFiles { std::move(files) }, mLoad { std::move(load) } {
+    mThread = std::jthread([this](std::stop_token stopToken) { run(stopToken); });
+}
+
+ShaderWatcher::~ShaderWatcher() {
+    mThread.request_stop();
+}
+
+std::optional<std::vector<std::string>> ShaderWatcher::takeChangedSources() {
+    std::unique_lock lock(mMutex, std::try_to_lock);
+    if (!lock.owns_lock() || !mChangedSources) {
+        return std::nullopt;
+    }
+    return std::exchange(mChangedSources, std::nullopt);
+}
+
+void ShaderWatcher::run(std::stop_token stopToken) {
+    ChangeMonitor monitor { mFiles };
+    while (!stopToken.stop_requested()) {
+        monitor.wait(stopToken);
+        if (stopToken.stop_requested()) {
+            break;
+        }
+        std::this_thread::sleep_for(kSettleDelay);
+        // events up to here belong to the save being read; anything later starts another round.
+        monitor.drain();
+        readSources();
+    }
+}
+
+void ShaderWatcher::readSources() {
+    auto sources { mLoad() };
+    if (sources.empty()) {
+        return;
+    }
+    std::lock_guard lock(mMutex);
+    mChangedSources = std::move(sources);
+}
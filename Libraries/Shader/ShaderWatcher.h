@@ -0,0 +1,41 @@
+#pragma once
+
+#include <filesystem>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <stop_token>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Watches a set of shader source files on a background thread (inotify on Linux,
+// modification time polling elsewhere) and runs a loader whenever one changes.
+// Nothing here touches GL, so the render thread only ever picks up finished reads.
+class ShaderWatcher {
+public:
+    // load runs on the watcher thread and returns the sources to hand to the render thread;
+    // an empty result means loading failed and nothing is reported.
+    using Loader = std::function<std::vector<std::string>()>;
+
+    ShaderWatcher(std::vector<std::filesystem::path> files, Loader load);
+    ShaderWatcher(const ShaderWatcher&) = delete;
+    ShaderWatcher& operator=(const ShaderWatcher&) = delete;
+    ~ShaderWatcher();
+
+    // the loader's result if any watched file changed since the last call.
+    // never blocks on the file system.
+    // ------------------------------------------------------------------------
+    std::optional<std::vector<std::string>> takeChangedSources();
+
+private:
+    std::vector<std::filesystem::path> mFiles;
+    Loader mLoad;
+    std::mutex mMutex;
+    std::optional<std::vector<std::string>> mChangedSources;
+    // declared last so the thread is stopped and joined before the members it uses are destroyed.
+    std::jthread mThread;
+
+    void run(std::stop_token stopToken);
+    void readSources();
+};
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <string_view>
+
+// string literal usable as a template argument, e.g. Uniform<"texture1", int>.
+template <std::size_t N>
+struct FixedString {
+    char data[N] {};
+
+    constexpr FixedString(const char (&string)[N]) {
+        std::copy_n(string, N, data);
+    }
+
+    constexpr std::string_view view() const {
+        return { data, N - 1 };
+    }
+};
+
+namespace detail {
+    // the GLSL type (as its GLenum value) a C++ uniform type maps to. 0 means unsupported.
+    template <typename T> constexpr unsigned int kGlslType { 0 };
+    template <> constexpr unsigned int kGlslType<bool> { 0x8B56 };      // GL_BOOL
+    template <> constexpr unsigned int kGlslType<int> { 0x1404 };       // GL_INT, also samplers
+    template <> constexpr unsigned int kGlslType<float> { 0x1406 };     // GL_FLOAT
+    template <> constexpr unsigned int kGlslType<glm::vec2> { 0x8B50 }; // GL_FLOAT_VEC2
+    template <> constexpr unsigned int kGlslType<glm::vec3> { 0x8B51 }; // GL_FLOAT_VEC3
+    template <> constexpr unsigned int kGlslType<glm::vec4> { 0x8B52 }; // GL_FLOAT_VEC4
+    template <> constexpr unsigned int kGlslType<glm::mat4> { 0x8B5C }; // GL_FLOAT_MAT4
+
+    // every Uniform type gets a small index into the per program location table.
+    inline std::size_t nextUniformSlot() {
+        static std::size_t next {};
+        return next++;
+    }
+}
+
+// A uniform named at compile time. Shader::set<U>() resolves the name once per program,
+// checks the GLSL type the program declares against T, and from then on is an indexed
+// load plus the shadowed glUniform call, with no string hashing or driver lookup.
+//
+//     using Texture1 = Uniform<"texture1", int>;
+//     shader.set<Texture1>(0);
+template <FixedString Name, typename T>
+struct Uniform {
+    static_assert(detail::kGlslType<T> != 0, "no GLSL uniform type is known for this C++ type");
+
+    using Type = T;
+    static constexpr std::string_view kName { Name.view() };
+    static constexpr unsigned int kGlslType { detail::kGlslType<T> };
+
+    static std::size_t slot() {
+        static const std::size_t slot { detail::nextUniformSlot() };
+        return slot;
+    }
+};
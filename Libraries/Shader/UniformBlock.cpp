@@ -0,0 +1,20 @@
+#include "UniformBlock.h"
+
+#include <GlDebug.h>
+#include <GlState.h>
+#include <glad/glad.h>
+
+UniformBuffer::UniformBuffer(unsigned int binding, size_t size)
+    : mBuffer { GlBuffer::create() }, mBinding { binding }, mSize { size } {
+    GlState::shared().bindBuffer(GL_UNIFORM_BUFFER, mBuffer.get());
+    // a block of a single vec2 is 8 bytes to C++, but drivers may expect the 16 std140 rounds it up to.
+    const size_t storageSize { (mSize + 15) / 16 * 16 };
+    GLCHECK(glBufferData(GL_UNIFORM_BUFFER, static_cast<GLsizeiptr>(storageSize), nullptr, GL_DYNAMIC_DRAW));
+    // the binding point keeps this buffer until something else is bound to it.
+    GlState::shared().bindBufferBase(GL_UNIFORM_BUFFER, mBinding, mBuffer.get());
+}
+
+void UniformBuffer::upload(const void* data) {
+    GlState::shared().bindBuffer(GL_UNIFORM_BUFFER, mBuffer.get());
+    GLCHECK(glBufferSubData(GL_UNIFORM_BUFFER, 0, static_cast<GLsizeiptr>(mSize), data));
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <GlHandle.h>
+
+#include <cstddef>
+#include <type_traits>
+
+// Compile time check of one member offset of a std140 block struct, e.g.
+//
+//     struct FrameData {
+//         float time;               // offset 0
+//         float pad;
+//         glm::vec2 viewport;       // offset 8, vec2 aligns to 8
+//         glm::mat4 viewProjection; // offset 16, mat4 aligns to 16
+//     };
+//     UNIFORM_BLOCK_OFFSET(FrameData, viewport, 8);
+//     UNIFORM_BLOCK_OFFSET(FrameData, viewProjection, 16);
+//
+// vec3 members are the usual trap: std140 aligns them to 16 bytes, glm::vec3 only to 4.
+#define UNIFORM_BLOCK_OFFSET(Block, member, offset) \
+    static_assert(offsetof(Block, member) == (offset), #Block "::" #member " is not at std140 offset " #offset)
+
+// GL buffer object bound to a uniform buffer binding point. See UniformBlock for the typed version.
+class UniformBuffer {
+public:
+    UniformBuffer(unsigned int binding, size_t size);
+
+    unsigned int binding() const { return mBinding; }
+    size_t size() const { return mSize; }
+
+protected:
+    // replace the whole buffer contents with a single glBufferSubData.
+    // ------------------------------------------------------------------------
+    void upload(const void* data);
+
+private:
+    GlBuffer mBuffer;
+    unsigned int mBinding {};
+    size_t mSize {};
+};
+
+// A C++ struct mirrored into a std140 uniform block. Every program that binds the block
+// name to binding() (Shader::bindUniformBlock) reads the same buffer, so data shared by
+// many programs, like time or the camera, costs one upload per frame instead of one
+// glUniform call per value per program.
+//
+// Member offsets are not checked automatically: nothing compares the struct layout with
+// std140 except the UNIFORM_BLOCK_OFFSET lines written next to it, plus the whole block size
+// when it is passed to Shader::bindUniformBlock. The GL buffer is rounded up to 16 bytes,
+// since drivers may report the std140 block size that way.
+template <typename T>
+class UniformBlock : public UniformBuffer {
+    static_assert(std::is_standard_layout_v<T> && std::is_trivially_copyable_v<T>,
+                  "uniform block structs are copied into GL memory as raw bytes");
+    static_assert(sizeof(T) % 4 == 0,
+                  "std140 members are made of 4 byte components, so a block size is a multiple of 4");
+
+public:
+    explicit UniformBlock(unsigned int binding) : UniformBuffer(binding, sizeof(T)) {}
+
+    // upload a new value for the block.
+    // ------------------------------------------------------------------------
+    void update(const T& value) { upload(&value); }
+};
@@ -4,7 +4,10 @@ layout (location = 0) in vec3 aPos;
 layout (location = 1) in vec3 aColor;
 out vec3 ourColor;
 
+// object transform; the vertex data itself never changes after upload
+uniform mat4 model;
+
 void main() {
-	gl_Position = vec4(aPos, 1.0);
+	gl_Position = model * vec4(aPos, 1.0);
 	ourColor = aColor;
 }
\ No newline at end of file
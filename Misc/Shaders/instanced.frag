@@ -0,0 +1,30 @@
+#version 330 core
+out vec4 FragColor;
+
+in vec2 TexCoord;
+in vec4 tint;
+flat in int textureIndex;
+
+// texture samplers, set to units 0 to 3 by InstancedQuads
+uniform sampler2D texture0;
+uniform sampler2D texture1;
+uniform sampler2D texture2;
+uniform sampler2D texture3;
+
+void main()
+{
+	// GLSL 3.30 cannot pick a sampler with a varying, so branch instead. the gradients are
+	// taken outside the branch, where implicit derivatives would be undefined.
+	vec2 dx = dFdx(TexCoord);
+	vec2 dy = dFdy(TexCoord);
+	vec4 color;
+	if (textureIndex == 0)
+		color = textureGrad(texture0, TexCoord, dx, dy);
+	else if (textureIndex == 1)
+		color = textureGrad(texture1, TexCoord, dx, dy);
+	else if (textureIndex == 2)
+		color = textureGrad(texture2, TexCoord, dx, dy);
+	else
+		color = textureGrad(texture3, TexCoord, dx, dy);
+	FragColor = color * tint;
+}
\ No newline at end of file
@@ -0,0 +1,26 @@
+#version 330 core
+// unit quad, shared by every instance
+layout (location = 0) in vec2 aPos;
+layout (location = 1) in vec2 aTexCoord;
+// per instance (see InstancedQuads::Instance)
+layout (location = 2) in vec2 aOffset;
+layout (location = 3) in vec2 aScale;
+layout (location = 4) in float aRotation;
+layout (location = 5) in float aTextureIndex;
+layout (location = 6) in vec4 aTint;
+
+out vec2 TexCoord;
+out vec4 tint;
+flat out int textureIndex;
+
+void main()
+{
+    // scale, rotate about the quad center, then move into place
+    vec2 scaled = aPos * aScale;
+    float c = cos(aRotation);
+    float s = sin(aRotation);
+    gl_Position = vec4(vec2(c * scaled.x - s * scaled.y, s * scaled.x + c * scaled.y) + aOffset, 0.0, 1.0);
+    TexCoord = aTexCoord;
+    tint = aTint;
+    textureIndex = int(aTextureIndex);
+}
\ No newline at end of file
@@ -8,8 +8,22 @@ in vec2 TexCoord;
 uniform sampler2D texture1;
 uniform sampler2D texture2;
 
+// variant features (see ShaderVariants): SINGLE_TEXTURE, ALPHA_TEST, MIX_FACTOR
+#ifndef MIX_FACTOR
+#define MIX_FACTOR 0.25
+#endif
+
 void main()
 {
-	// linearly interpolate between both textures (80% container, 20% awesomeface)
-	FragColor = mix(texture(texture1, TexCoord), texture(texture2, TexCoord), 0.25);
+#ifdef SINGLE_TEXTURE
+	vec4 color = texture(texture1, TexCoord);
+#else
+	// linearly interpolate between both textures (75% container, 25% awesomeface by default)
+	vec4 color = mix(texture(texture1, TexCoord), texture(texture2, TexCoord), MIX_FACTOR);
+#endif
+#ifdef ALPHA_TEST
+	if (color.a < 0.1)
+		discard;
+#endif
+	FragColor = color;
 }
\ No newline at end of file
@@ -1,7 +1,6 @@
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
-#include <glm/mat3x3.hpp>
-#include <glm/ext/matrix_transform.hpp>
+#include <glm/glm.hpp>
 
 #include <iostream>
 #include <array>
@@ -9,6 +8,12 @@
 #include <format>
 
 #include <Shader.h>
+#include <EmbeddedShaders.h>
+#include <GlDebug.h>
+#include <GlHandle.h>
+#include <GlState.h>
+#include <Transform2D.h>
+#include <VertexArrayCache.h>
 
 void frameBufferSizeCallback(GLFWwindow* window, int width, int height) {
     glViewport(0, 0, width, height);
@@ -26,97 +31,52 @@ struct Vertex {
     glm::vec3 color {};
 };
 
-class Triangle {
-public:
-    Triangle(const Vertex& vertex1,const Vertex& vertex2, const Vertex& vertex3) : mVerticies { vertex1, vertex2, vertex3 } {
-        glGenVertexArrays(1, &mVAO);
-        glGenBuffers(1, &mVBO);
-
-        glBindVertexArray(mVAO);
-
-        glBindBuffer(GL_ARRAY_BUFFER, mVBO);
-        glBufferData(GL_ARRAY_BUFFER, mVerticies.size() * sizeof(Vertex), mVerticies.data(), GL_DYNAMIC_DRAW);
-
-        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (const void*)0);
-        glEnableVertexAttribArray(0);
-        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (const void*)(3 * sizeof(float)));
-        glEnableVertexAttribArray(1);
-    }
-
-    void draw() {
-
+const VertexLayout kVertexLayout { VertexLayout::of<Vertex>({
+    VertexLayout::attribute("aPos", &Vertex::pos),
+    VertexLayout::attribute("aColor", &Vertex::color) }) };
 
+// object transform of basic.vert
+using ModelUniform = Uniform<"model", glm::mat4>;
 
-        glBindVertexArray(mVAO);
-        glDrawArrays(GL_TRIANGLES, 0, 3);
-    }
-
-    void rotate(const float angleRad) {
-
-        float centerX {};
-        float centerY {};
-        for (auto& vertex : mVerticies) {
-            centerX += vertex.pos.x;
-            centerY += vertex.pos.y;
-        }
-        centerX /= 3;
-        centerY /= 3;
-
-        const glm::mat3x3 translationMatrix1 { {1,        0,        0},
-                                               {0,        1,        0},
-                                               {-centerX, -centerY, 1} };
-        const glm::mat3x3 translationMatrix2 { {1,        0,        0},
-                                               {0,        1,        0},
-                                               {centerX,  centerY,  1} };
+class Triangle {
+public:
+    Triangle(const Vertex& vertex1,const Vertex& vertex2, const Vertex& vertex3)
+        : Triangle(std::array { vertex1, vertex2, vertex3 }) {}
 
-        const glm::mat3x3 rotationMatrix { {glm::cos(angleRad)     , glm::sin(angleRad), 0},
-                                           {-glm::sin(angleRad)    , glm::cos(angleRad), 0},
-                                           {0                      , 0                 , 1} };
+    void draw(Shader& shader) {
 
-        const glm::mat3x3 matrixT { translationMatrix2 * rotationMatrix * translationMatrix1 };
+        shader.set<ModelUniform>(mTransform.model());
 
-        for (auto& vertex : mVerticies) {
-            vertex.pos = matrixT * vertex.pos;
-        }
+        mVertexArrays.bind(shader);
+        GLCHECK(glDrawArrays(GL_TRIANGLES, 0, 3));
     }
 
-    void translate(const float moveX, const float moveY) {
-        for (auto& vertex : mVerticies) {
-            vertex.pos.x += moveX;
-            vertex.pos.y += moveY;
-        }
+    // the triangle is created once and kept; moving it only changes the matrix the next draw uploads.
+    // angleRad turns it about its centroid, position offsets it from where its vertices were uploaded.
+    void setRotation(const float angleRad) {
+        mTransform.setRotation(angleRad);
     }
 
-    ~Triangle() {
-        glDeleteVertexArrays(1, &mVAO);
-        glDeleteBuffers(1, &mVBO);
+    void setPosition(const float x, const float y) {
+        mTransform.setPosition(x, y);
     }
 
 private :
-    std::array<Vertex, 3> mVerticies {};
-    unsigned int mVAO {};
-    unsigned int mVBO {};
-};
-
-void rotateTriangle(std::array<glm::vec3, 3>& verticies, float angle) {
-    const glm::mat3x3 rotationMatrix { {glm::cos(angle), glm::sin(angle), 0},
-                             {-1 * glm::sin(angle), glm::cos(angle)   , 0},
-                             {0              , 0                 , 1} };
-
-    for (auto& verticy : verticies) {
-        verticy = rotationMatrix * verticy;
-    }
-
-}
-
-void moveTriangle(std::array<glm::vec3, 3>& verticies, float x, float y) {
-
-    for (auto& verticy : verticies) {
-        verticy.x += x;
-        verticy.y += y;
+    GlBuffer mVBO;
+    VertexArrayCache mVertexArrays;
+    // the vertices are never rewritten, the transform goes to the shader.
+    Transform2D mTransform;
+
+    explicit Triangle(const std::array<Vertex, 3>& verticies)
+        : mVBO { createVertexBuffer(verticies) }, mVertexArrays { kVertexLayout, mVBO.get() }, mTransform { verticies } {}
+
+    static GlBuffer createVertexBuffer(const std::array<Vertex, 3>& verticies) {
+        auto buffer { GlBuffer::create() };
+        GlState::shared().bindBuffer(GL_ARRAY_BUFFER, buffer.get());
+        GLCHECK(glBufferData(GL_ARRAY_BUFFER, verticies.size() * sizeof(Vertex), verticies.data(), GL_STATIC_DRAW));
+        return buffer;
     }
-
-}
+};
 
 
 int main() {
@@ -129,6 +89,9 @@ int main() {
     glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
     glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
     glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+#ifndef NDEBUG
+    glfwWindowHint(GLFW_OPENGL_DEBUG_CONTEXT, GLFW_TRUE);
+#endif
     auto window { glfwCreateWindow(kWindowWidth, kWindowHeight, "My Test Window", nullptr, nullptr) };
 
     if (window == nullptr) {
@@ -143,14 +106,22 @@ int main() {
         std::cerr << "Failed to initiliaze GLAD\n";
         return -1;
     }
+    GlDebug::enable();
     std::cout << "OpenGL Version: " << glGetString(GL_VERSION) << '\n';
     // Set the OpenGL viewport size and assign the callback function so that the size is always the same as window size.
     glViewport(0, 0, kWindowWidth, kWindowHeight);
     glfwSetFramebufferSizeCallback(window, frameBufferSizeCallback);
     
-    Shader ourShader("Shaders/basic.vert", "Shaders/basic.frag");
+    // The shader sources are compiled into the executable, so this works from any working directory.
+    Shader ourShader(ShaderSource { EmbeddedShaders::find("basic.vert"), EmbeddedShaders::find("basic.frag") });
     ourShader.use();
 
+    // The triangle lives as long as the loop; each frame only updates its transform.
+    constexpr Vertex vertex1 { glm::vec3(0.5f, -0.5f, 1.0f),  glm::vec3(1.0f, 0.0f, 0.0f) };
+    constexpr Vertex vertex2 { glm::vec3(-0.5f, -0.5f, 1.0f),  glm::vec3(0.0f, 1.0f, 0.0f) };
+    constexpr Vertex vertex3 { glm::vec3(0.0f,  0.5f, 1.0f),  glm::vec3(0.0f, 0.0f, 1.0f) };
+    Triangle triangle(vertex1, vertex2, vertex3);
+
     // The main event loop.
     constexpr float kMoveSpeed { 1.0f / 1.0f };
     float moveX { 0 }, moveY { 0 };
@@ -193,17 +164,10 @@ int main() {
 
         std::cout << std::format("Angle: {:.2f}\n", angle);
 
-        constexpr Vertex vertex1 { glm::vec3(0.5f, -0.5f, 1.0f),  glm::vec3(1.0f, 0.0f, 0.0f) };
-        constexpr Vertex vertex2 { glm::vec3(-0.5f, -0.5f, 1.0f),  glm::vec3(0.0f, 1.0f, 0.0f) };
-        constexpr Vertex vertex3 { glm::vec3(0.0f,  0.5f, 1.0f),  glm::vec3(0.0f, 0.0f, 1.0f) };
-
-        Triangle triangle(vertex1, vertex2, vertex3);
-
-
-        triangle.rotate(angle);
-        triangle.translate(moveX, moveY);
+        triangle.setRotation(static_cast<float>(angle));
+        triangle.setPosition(moveX, moveY);
 
-        triangle.draw();
+        triangle.draw(ourShader);
 
         glfwSwapBuffers(window);
         glfwPollEvents();